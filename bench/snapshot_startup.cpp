@@ -0,0 +1,76 @@
+//Startup cost of a module: lexing its source vs reusing a snapshot image
+//(open + mmap + source hash check + rebuilding the Token vector).
+//
+//Build and run from the repository root:
+//  g++ -std=c++17 -O2 -pthread -Iinclude -o snapshot_startup bench/snapshot_startup.cpp
+//      src/runtime/snapshot.cpp src/compiler/lexer/lexer.cpp
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "pebas/runtime/snapshot.h"
+
+using namespace pebas;
+
+static constexpr int FUNCTIONS = 20000;
+static constexpr int RUNS = 5;
+
+template <typename Function>
+static double bestMilliseconds(Function function) {
+  double best = 1e300;
+  for (int run = 0; run < RUNS; run++) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto end = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  return best;
+}
+
+int main() {
+  const std::string name = "/home/user/project/src/module.pb";
+  const std::string image = "snapshot_startup.img";
+
+  std::string source;
+  for (int i = 0; i < FUNCTIONS; i++) {
+    source += "function f" + std::to_string(i) + "(a: int, b: int) -> int {\n"
+              "  var x = a + b * 3; # running total\n"
+              "  for (i : 0..10) { x = x + i; }\n"
+              "  return x != 0 && \"done\" == \"done\";\n"
+              "}\n";
+  }
+
+  Lexer lexer(source, name);
+  std::vector<Token> tokens = lexer.tokenizer();
+  SnapshotWriter writer;
+  writer.addModule(name, source, tokens);
+  if (!writer.write(image)) {
+    std::cerr << "Could not write '" << image << "'.\n";
+    return 1;
+  }
+
+  size_t count = 0;
+  double lexing = bestMilliseconds([&]() {
+    Lexer lexer(source, name);
+    count = lexer.tokenizer().size();
+  });
+  double loading = bestMilliseconds([&]() {
+    auto snapshot = SnapshotImage::open(image);
+    int module = snapshot ? snapshot->findModule(name, source) : -1;
+    count = module >= 0 ? snapshot->getTokens(module).size() : 0;
+  });
+  std::remove(image.c_str());
+
+  if (count != tokens.size()) {
+    std::cerr << "Snapshot returned " << count << " tokens, expected " << tokens.size() << ".\n";
+    return 1;
+  }
+
+  std::cout << source.size() << " bytes, " << tokens.size() << " tokens (best of " << RUNS << ")\n"
+            << "  lex source:     " << lexing << " ms\n"
+            << "  snapshot image: " << loading << " ms\n"
+            << "  speedup:        " << lexing / loading << "x\n";
+  return 0;
+}
@@ -5,17 +5,18 @@
 #include <vector>
 #include <memory>
 #include <optional>
+#include <functional>
 #include "pebas/lexer/lexer.h"
 
 namespace pebas {
 
 enum class NodeType {
 
-  LITERAL, IDENTIFIER, UNARY, BINARY, GROUPING, CALL, MEMBER_ACCESS, ARRAY_ACCESS, ASSIGMENT,
+  LITERAL, IDENTIFIER, UNARY, BINARY, GROUPING, CALL, MEMBER_ACCESS, ARRAY_ACCESS, ASSIGNMENT,
 
-  VARIABEL_DECL, FUNCTION, CLASS, INTERFACE, ENUM, STRUCT,
+  VARIABLE_DECL, FUNCTION, CLASS, INTERFACE, ENUM, STRUCT, IMPORT,
 
-  BLOCK, IF, WHILE, FOR, RETURN, EXPRESSION_STMT
+  BLOCK, IF, WHILE, FOR, FOR_RANGE, RETURN, PRINT, EXPRESSION_STMT
 };
 
 //Base class for all AST nodes
@@ -42,7 +43,7 @@ public:
   NodeType getType() const override { return NodeType::LITERAL;}
   SourceLocation getLocation() const override { return token.location; }
 
-  IdentifierExpr(const Token& token) : token(token) {}
+  LiteralExpr(const Token& token) : token(token) {}
 
 private:
   Token token;
@@ -65,7 +66,7 @@ private:
 
 
 //negation ...
-class UnaryExpr : Expression {
+class UnaryExpr : public Expression {
 public:
   TokenType getOperator() const {return op.type; }
   const Expression* getOperand() const {return operand.get(); }
@@ -73,7 +74,7 @@ public:
   NodeType getType() const override { return NodeType::UNARY; }
   SourceLocation getLocation() const override {return op.location; }
 
-  UnaryExpr(const token& op, std::unique_ptr<Epression> operand)
+  UnaryExpr(const Token& op, std::unique_ptr<Expression> operand)
   : op(op), operand(std::move(operand)) {}
 
 private:
@@ -101,19 +102,141 @@ private:
   std::unique_ptr<Expression> right;
 };
 
+//Function calls: callee(arguments ...)
+class CallExpr : public Expression {
+public:
+  const Expression* getCallee() const { return callee.get(); }
+  const std::vector<std::unique_ptr<Expression>>& getArguments() const { return arguments; }
+
+  NodeType getType() const override { return NodeType::CALL; }
+  SourceLocation getLocation() const override { return paren.location; }
+
+  CallExpr(std::unique_ptr<Expression> callee, const Token& paren, std::vector<std::unique_ptr<Expression>> arguments)
+    : callee(std::move(callee)), paren(paren), arguments(std::move(arguments)) {}
+
+private:
+  std::unique_ptr<Expression> callee;
+  Token paren;
+  std::vector<std::unique_ptr<Expression>> arguments;
+};
+
+//Assignment to a variable: name = value
+class AssignExpr : public Expression {
+public:
+  std::string getName() const { return name.lexeme; }
+  const Expression* getValue() const { return value.get(); }
+
+  NodeType getType() const override { return NodeType::ASSIGNMENT; }
+  SourceLocation getLocation() const override { return name.location; }
+
+  AssignExpr(const Token& name, std::unique_ptr<Expression> value)
+    : name(name), value(std::move(value)) {}
+
+private:
+  Token name;
+  std::unique_ptr<Expression> value;
+};
+
 //Base class for declarations 
 class Statement : public ASTNode{
 };
 
+//Expression evaluated for its side effects
+class ExpressionStmt : public Statement {
+public:
+  const Expression* getExpression() const { return expression.get(); }
+
+  NodeType getType() const override { return NodeType::EXPRESSION_STMT; }
+  SourceLocation getLocation() const override { return location; }
+
+  ExpressionStmt(std::unique_ptr<Expression> expression, SourceLocation location)
+    : expression(std::move(expression)), location(location) {}
+
+private:
+  std::unique_ptr<Expression> expression;
+  SourceLocation location;
+};
+
+//if (condition) thenBranch else elseBranch; elseBranch may be null
+class IfStmt : public Statement {
+public:
+  const Expression* getCondition() const { return condition.get(); }
+  const Statement* getThenBranch() const { return thenBranch.get(); }
+  const Statement* getElseBranch() const { return elseBranch.get(); }
+
+  NodeType getType() const override { return NodeType::IF; }
+  SourceLocation getLocation() const override { return location; }
+
+  IfStmt(std::unique_ptr<Expression> condition, std::unique_ptr<Statement> thenBranch,
+         std::unique_ptr<Statement> elseBranch, SourceLocation location)
+    : condition(std::move(condition)), thenBranch(std::move(thenBranch)),
+      elseBranch(std::move(elseBranch)), location(location) {}
+
+private:
+  std::unique_ptr<Expression> condition;
+  std::unique_ptr<Statement> thenBranch;
+  std::unique_ptr<Statement> elseBranch;
+  SourceLocation location;
+};
+
+class WhileStmt : public Statement {
+public:
+  const Expression* getCondition() const { return condition.get(); }
+  const Statement* getBody() const { return body.get(); }
+
+  NodeType getType() const override { return NodeType::WHILE; }
+  SourceLocation getLocation() const override { return location; }
+
+  WhileStmt(std::unique_ptr<Expression> condition, std::unique_ptr<Statement> body, SourceLocation location)
+    : condition(std::move(condition)), body(std::move(body)), location(location) {}
+
+private:
+  std::unique_ptr<Expression> condition;
+  std::unique_ptr<Statement> body;
+  SourceLocation location;
+};
+
+//return value; value is null for a bare `return;`
+class ReturnStmt : public Statement {
+public:
+  const Expression* getValue() const { return value.get(); }
+
+  NodeType getType() const override { return NodeType::RETURN; }
+  SourceLocation getLocation() const override { return location; }
+
+  ReturnStmt(std::unique_ptr<Expression> value, SourceLocation location)
+    : value(std::move(value)), location(location) {}
+
+private:
+  std::unique_ptr<Expression> value;
+  SourceLocation location;
+};
+
+//print expr; writes the value and a newline through the runtime's printValue()
+class PrintStmt : public Statement {
+public:
+  const Expression* getValue() const { return value.get(); }
+
+  NodeType getType() const override { return NodeType::PRINT; }
+  SourceLocation getLocation() const override { return location; }
+
+  PrintStmt(std::unique_ptr<Expression> value, SourceLocation location)
+    : value(std::move(value)), location(location) {}
+
+private:
+  std::unique_ptr<Expression> value;
+  SourceLocation location;
+};
+
 //Sequence of statements 
-class BlockSmt : public Statement {
+class BlockStmt : public Statement {
 public:
   const std::vector<std::unique_ptr<Statement>>& getStatements() const { return statements; }
 
   NodeType getType() const override { return NodeType::BLOCK; }
   SourceLocation getLocation() const override { return location; }
 
-  BlockSmt(std::<std::unique_ptr<Statement>> statements, SourceLocation location)
+  BlockStmt(std::vector<std::unique_ptr<Statement>> statements, SourceLocation location)
            : statements(std::move(statements)), location(location) {}
 
 private:
@@ -128,7 +251,7 @@ public:
   std::optional<std::string> getTypeName() const { return typeName; }
   const Expression* getInitializer() const { return initializer.get(); }
 
-  Nodeztype getType() const override { return Nodetype::VARIABLE_DECL; }
+  NodeType getType() const override { return NodeType::VARIABLE_DECL; }
   SourceLocation getLocation() const override {return name.location; }
 
   VariableDecl(const Token& name, std::optional<std::string> typeName, std::unique_ptr<Expression> initializer)
@@ -140,6 +263,43 @@ private:
   std::unique_ptr<Expression> initializer;
 };
 
+//Module import: import "path";
+class ImportDecl : public Statement {
+public:
+  std::string getPath() const { return path.stringValue; }
+
+  NodeType getType() const override { return NodeType::IMPORT; }
+  SourceLocation getLocation() const override { return path.location; }
+
+  ImportDecl(const Token& path) : path(path) {}
+
+private:
+  Token path;
+};
+
+//Counted loop over a half-open range: for (i : start..end)
+//Stores the loop variable, the two bound expressions and the body.
+class ForRangeStmt : public Statement {
+public:
+  std::string getVariable() const { return variable.lexeme; }
+  const Expression* getStart() const { return start.get(); }
+  const Expression* getEnd() const { return end.get(); }
+  const Statement* getBody() const { return body.get(); }
+
+  NodeType getType() const override { return NodeType::FOR_RANGE; }
+  SourceLocation getLocation() const override { return variable.location; }
+
+  ForRangeStmt(const Token& variable, std::unique_ptr<Expression> start,
+               std::unique_ptr<Expression> end, std::unique_ptr<Statement> body)
+      : variable(variable), start(std::move(start)), end(std::move(end)), body(std::move(body)) {}
+
+private:
+  Token variable;
+  std::unique_ptr<Expression> start;
+  std::unique_ptr<Expression> end;
+  std::unique_ptr<Statement> body;
+};
+
 //Structure to represent a Function parameter 
 struct Parameter {
   std::string name;
@@ -156,30 +316,53 @@ public:
   std::string getName() const { return name.lexeme; }
   const std::vector<Parameter>& getParameters() const { return parameters; }
   std::optional<std::string> getReturntype() const {return returnType; }
-  const BlockStm* getBody() getReturnType() const { return body.get(); }
+  //A deferred body (lazy parsing) is built on first use.
+  //If it has a syntax error the body is null and getBodyError() says why.
+  const BlockStmt* getBody() const {
+    if (parseBody) {
+      auto parse = std::move(parseBody);
+      parseBody = nullptr;
+      body = parse(bodyError);
+    }
+    return body.get();
+  }
+  bool isBodyParsed() const { return !parseBody; }
+  const std::string& getBodyError() const { return bodyError; }
+
+  NodeType getType() const override { return NodeType::FUNCTION; }
+  SourceLocation getLocation() const override { return name.location; }
 
   FunctionDecl(
-    const Token& name;
-  std::vector<parameter> parameters,
+    const Token& name,
+  std::vector<Parameter> parameters,
   std::optional<std::string> returnType,
   std::unique_ptr<BlockStmt> body 
   ) : name(name), parameters(std::move(parameters)),returnType(returnType), body(std::move(body)) {}
 
+  FunctionDecl(const Token& name, std::vector<Parameter> parameters,
+               std::optional<std::string> returnType,
+               std::function<std::unique_ptr<BlockStmt>(std::string& error)> parseBody)
+      : name(name), parameters(std::move(parameters)), returnType(returnType), parseBody(std::move(parseBody)) {}
+
 private:
   Token name;
   std::vector<Parameter> parameters;
   std::optional<std::string> returnType;
-  std::unique_ptr<BlockStmt> body;
+  mutable std::unique_ptr<BlockStmt> body;
+  mutable std::function<std::unique_ptr<BlockStmt>(std::string& error)> parseBody;
+  mutable std::string bodyError;
 };
 
 class Program{
 public:
   const std::vector<std::unique_ptr<Statement>>& getStatements() const { return statements;}
 
-  Program(std::vector<std::unique_ptr<Statement>> statments)
+  Program(std::vector<std::unique_ptr<Statement>> statements)
           : statements(std::move(statements)) {}
 
-);
+private:
+  std::vector<std::unique_ptr<Statement>> statements;
+};
 }
 
 #endif
@@ -0,0 +1,28 @@
+#ifndef PEBAS_AST_PRINTER_H
+#define PEBAS_AST_PRINTER_H
+
+#include <ostream>
+#include "pebas/ast/ast.h"
+
+namespace pebas {
+
+const char* nodeTypeName(NodeType type);
+
+//Prints a Program as an indented tree, one node per line:
+//  <NODE_TYPE> <details> @ file:line:column
+class AstPrinter {
+public:
+  AstPrinter(std::ostream& out) : out(out) {}
+
+  void print(const Program& program);
+  void print(const ASTNode* node, int depth = 0);
+
+private:
+  std::ostream& out;
+
+  void line(const ASTNode* node, int depth, const std::string& details);
+};
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef PEBAS_COMPILE_SERVER_H
+#define PEBAS_COMPILE_SERVER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "pebas/ast/ast.h"
+#include "pebas/lexer/lexer.h"
+
+namespace pebas {
+
+//A parsed module kept in memory between compiler invocations
+struct CachedModule {
+  std::string path;
+  int64_t mtime = 0;
+  uint64_t size = 0;
+  uint64_t hash = 0;
+  std::shared_ptr<const std::vector<Token>> tokens;
+  std::unique_ptr<Program> program;
+  std::vector<std::string> imports; //canonical paths from `import "file";`
+  std::vector<std::string> errors; //"file:line:column: message", bodies included
+  bool watched = false; //inotify will report changes, so no stat is needed
+  bool stale = false;
+};
+
+//Parsed modules keyed by canonical path; a module is only re-lexed and
+//re-parsed when its contents (not just its mtime) change
+class ModuleCache {
+public:
+  //Returns nullptr and sets `error` if the file cannot be read
+  const CachedModule* load(const std::string& path, std::string& error);
+
+  //Marks `path` for re-checking. Modules that import it are left alone:
+  //nothing parsed from a module depends on its imports yet.
+  void invalidate(const std::string& path);
+  void invalidateAll();
+  void markWatched(const std::string& path);
+
+  size_t getModuleCount() const { return modules.size(); }
+  size_t getParseCount() const { return parseCount; }
+
+private:
+  std::unordered_map<std::string, std::unique_ptr<CachedModule>> modules;
+  size_t parseCount = 0;
+
+  void parse(CachedModule& module, const std::string& source);
+};
+
+//Long-lived compile daemon on a Unix socket.
+//Each connection sends one request line and gets the reply back:
+//  check <absolute path>   parse the module and its imports, report syntax errors
+//  stats                   cache counters
+//  shutdown                stop the server
+class CompileServer {
+public:
+  CompileServer(const std::string& socketPath) : socketPath(socketPath) {}
+  ~CompileServer();
+
+  bool start(std::string& error);
+  void run();
+
+private:
+  std::string socketPath;
+  int listenFd = -1;
+  int inotifyFd = -1;
+  bool running = false;
+  ModuleCache cache;
+  std::unordered_map<int, std::string> watchDirectories;
+  std::unordered_map<std::string, int> directoryWatches;
+
+  bool watch(const std::string& path);
+  void handleFileEvents();
+  void handleClient(int fd);
+  std::string handleRequest(const std::string& request);
+  std::string check(const std::string& path);
+};
+
+//Sends one request to a running server and prints its reply; returns the exit code
+int runCompileClient(const std::string& socketPath, const std::string& request);
+
+}
+
+#endif
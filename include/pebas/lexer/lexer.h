@@ -1,6 +1,7 @@
 #ifndef PEBAS_LEXER_H
 #define PEBAS_LEXER_H 
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
@@ -63,50 +64,90 @@ enum class TokenType {
 
 }; 
 
+//Position of a token in its source file (1-based line and column)
+struct SourceLocation {
+  std::string filename;
+  int line;
+  int column;
+
+  SourceLocation(std::string filename, int line, int column)
+    : filename(std::move(filename)), line(line), column(column) {}
+
+  std::string to_string() const;
+};
+
+const char* tokenTypeName(TokenType type);
+
+//Bump whenever the tokens produced for some input change; cached token
+//streams (snapshot images) are only reused by the same revision
+constexpr uint32_t LEXER_REVISION = 2;
+
 struct Token {
   TokenType type;
   std::string lexeme;
-  int line;
-  int col;
+  SourceLocation location;
+  int intValue = 0;
+  double floatValue = 0.0;
+  bool boolValue = false;
+  std::string stringValue;
 
-  TokenType(TokenType type, std::string lexeme, int line, int col);
+  Token(TokenType type, std::string lexeme, SourceLocation location)
+    : type(type), lexeme(std::move(lexeme)), location(std::move(location)) {}
 
   std::string to_string() const;
 };
 
+//Where a chunk of source starts, for parallel lexing
+enum class LexState {
+  NORMAL, BLOCK_COMMENT, STRING
+};
+
 class Lexer {
 public:
-  Lexer(std::string source);
-  std::vector<Token> scan_Tokens();
+  //The source must outlive the lexer; tokens copy what they need
+  Lexer(const std::string& source, const std::string& filename);
 
-private: 
-  std::string m_source;
-  std::vector<Token> m_tokens;
-  std::map<std::string, TokenType> m_keywords;
+  Token nextToken();
+  std::vector<Token> tokenizer();
+  //Smaller chunks are not worth a thread
+  static constexpr size_t MIN_PARALLEL_CHUNK = 1 << 20;
 
-  int m_start = 0;
-  int m_current = 0;
-  int m_line = 1;
-  int m_column = 1;
+  //Same tokens as tokenizer(), lexed in chunks on several threads.
+  //threads == 0 uses every hardware thread.
+  std::vector<Token> tokenizerParallel(unsigned threads = 0, size_t minChunk = MIN_PARALLEL_CHUNK);
 
-  void scan_token_internal();
-  void add_token(TokenType type);
+private: 
+  const std::string& source;
+  std::string filename;
+  size_t start;
+  size_t current;
+  int line;
+  int column;
 
+  Lexer(const std::string& source, const std::string& filename, size_t begin, int line);
+  std::vector<Token> tokenizeChunk(size_t end, LexState entry);
+  static LexState scanChunk(const std::string& source, size_t begin, size_t end, LexState entry);
 
   char advance();
   char peek() const;
   char peekNext() const;
   bool match(char expected);
 
-  void string_literal(char quote_type = '"');
-  void number_literal();
-  void identifier();
-  void block_comment();
-
-  bool is_at_end() const;
-  bool is_digit(char c) const;
-  bool is_alpha(char c) const;
-  bool is_alpha_numeric(char c) const;
+  void skipWhitespace();
+  void skipComment();
+  bool skipString();
+  Token identifier();
+  Token number();
+  Token string();
+  Token character();
+  Token makeToken(TokenType type);
+  Token errorToken(const std::string& message);
+  TokenType identifierType();
+
+  bool isAtEnd() const;
+  bool isDigit(char c) const;
+  bool isAlpha(char c) const;
+  bool isAlphaNumeric(char c) const;
 };
 } 
 
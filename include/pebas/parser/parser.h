@@ -4,16 +4,16 @@
 #include <vector>
 #include <memory>
 #include <string>
-#include <stdexpect>
+#include <stdexcept>
 #include "pebas/lexer/lexer.h"
 #include "pebas/ast/ast.h"
 
 namespace pebas {
 
 //exception for parsing erros 
-class Parser : public std::runtime_error {
+class ParseError : public std::runtime_error {
 public:
-  ParserError(const std::string& message, const SourceLocation& location) 
+  ParseError(const std::string& message, const SourceLocation& location) 
       : std::runtime_error(message), location(location) {} 
 
   SourceLocation getLocation() const { return location; }
@@ -24,24 +24,39 @@ private:
   
 class Parser {
 public:
-  Parser(const std::vector<Token>& token);
+  Parser(const std::vector<Token>& tokens);
+  //Shared tokens enable lazy mode: function bodies are only brace-matched
+  //and parsed on first use, which keeps the tokens alive until then
+  Parser(std::shared_ptr<const std::vector<Token>> sharedTokens);
+
+  //Statements with a syntax error are skipped and recorded in getErrors()
+  std::unique_ptr<Program> parse();
+  const std::vector<ParseError>& getErrors() const { return errors; }
+
+private:
+  std::shared_ptr<const std::vector<Token>> sharedTokens;
+  const std::vector<Token>& tokens;
+  bool lazyBodies = false;
   size_t current =0;
+  std::vector<ParseError> errors;
 
   Token peek() const;
-  Token Previous() const;
+  Token previous() const;
   bool isAtEnd() const;
   Token advance();
-  bool check(TokenTyType type) const;
+  bool check(TokenType type) const;
   bool match(TokenType type);
   bool match(std::initializer_list<TokenType> types);
   Token consume(TokenType type, const std::string& message);
-  ParserError error(const Token& token, const std::string& message);
+  ParseError error(const Token& token, const std::string& message);
   void synchronize();
 
   //Parsing methods 
   std::unique_ptr<Statement> declaration();
+  std::unique_ptr<Statement> importDeclaration();
   std::unique_ptr<Statement> varDeclaration();
   std::unique_ptr<Statement> functionDeclaration();
+  void skipFunctionBody();
   std::unique_ptr<Statement> statement();
   std::unique_ptr<Statement> expressionStatement();
   std::unique_ptr<Statement> blockStatement();
@@ -49,18 +64,19 @@ public:
   std::unique_ptr<Statement> whileStatement();
   std::unique_ptr<Statement> forStatement();
   std::unique_ptr<Statement> returnStatement();
-  std::unique_ptr<Statement> expression();
-  std::unique_ptr<Statement> assinment();
-  std::unique_ptr<Statement> orExpression();
-  std::unique_ptr<Statement> andExpression();
-  std::unique_ptr<Statement> equality();
-  std::unique_ptr<Statement> comparison();
-  std::unique_ptr<Statement> term();
-  std::unique_ptr<Statement> factor();
-  std::unique_ptr<Statement> unary();
-  std::unique_ptr<Statement> call();
-  std::unique_ptr<Statement> primary();
-  std::unique_ptr<Statement> finishCall(std::unique_ptr<Expression> callee);
+  std::unique_ptr<Statement> printStatement();
+  std::unique_ptr<Expression> expression();
+  std::unique_ptr<Expression> assignment();
+  std::unique_ptr<Expression> orExpression();
+  std::unique_ptr<Expression> andExpression();
+  std::unique_ptr<Expression> equality();
+  std::unique_ptr<Expression> comparison();
+  std::unique_ptr<Expression> term();
+  std::unique_ptr<Expression> factor();
+  std::unique_ptr<Expression> unary();
+  std::unique_ptr<Expression> call();
+  std::unique_ptr<Expression> primary();
+  std::unique_ptr<Expression> finishCall(std::unique_ptr<Expression> callee);
 };
 }
 
@@ -0,0 +1,61 @@
+#ifndef PEBAS_BUILTINS_H
+#define PEBAS_BUILTINS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+#include "pebas/runtime/rope_string.h"
+
+namespace pebas {
+
+//Typed arrays with contiguous storage
+using IntArray = std::vector<int64_t>;
+using FloatArray = std::vector<double>;
+
+//Values exchanged between pebas code and native builtins
+using Value = std::variant<
+  std::monostate, int64_t, double, bool, RopeString,
+  std::shared_ptr<IntArray>, std::shared_ptr<FloatArray>
+>;
+
+using NativeFunction = Value (*)(const std::vector<Value>& args);
+
+//exception for bad builtin calls (wrong arity or argument types)
+class BuiltinError : public std::runtime_error {
+public:
+  BuiltinError(const std::string& message) : std::runtime_error(message) {}
+};
+
+//Returns the native entry point for a CALL to `name`, or nullptr
+NativeFunction findBuiltin(const std::string& name);
+
+//Vectorized kernels, also usable directly from C++
+//min/max expect count > 0
+int64_t sumInt(const int64_t* data, size_t count);
+double sumFloat(const double* data, size_t count);
+int64_t minInt(const int64_t* data, size_t count);
+double minFloat(const double* data, size_t count);
+int64_t maxInt(const int64_t* data, size_t count);
+double maxFloat(const double* data, size_t count);
+int64_t dotInt(const int64_t* a, const int64_t* b, size_t count);
+double dotFloat(const double* a, const double* b, size_t count);
+//Map with a constant: dst[i] = src[i] op value (src and dst may alias)
+void addConstInt(const int64_t* src, int64_t* dst, size_t count, int64_t value);
+void addConstFloat(const double* src, double* dst, size_t count, double value);
+void mulConstInt(const int64_t* src, int64_t* dst, size_t count, int64_t value);
+void mulConstFloat(const double* src, double* dst, size_t count, double value);
+
+//String kernels; find functions return -1 when there is no match
+int64_t findByte(std::string_view haystack, char byte, size_t from = 0);
+int64_t findString(std::string_view haystack, std::string_view needle, size_t from = 0);
+bool stringEquals(std::string_view a, std::string_view b);
+RopeString concat(const std::vector<const RopeString*>& parts);
+
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef PEBAS_OUTPUT_H
+#define PEBAS_OUTPUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include "pebas/runtime/builtins.h"
+#include "pebas/runtime/rope_string.h"
+
+namespace pebas {
+
+//Buffered writer behind `print`.
+//Values are formatted straight into the buffer. When it fills, the complete
+//lines are written with a single write(2); flush() and destruction write
+//everything. When the fd is a TTY every completed line is flushed so
+//interactive output is not delayed.
+class OutputBuffer {
+public:
+  static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+  OutputBuffer(int fd, size_t capacity = DEFAULT_CAPACITY);
+  ~OutputBuffer();
+
+  OutputBuffer(const OutputBuffer&) = delete;
+  OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+  //Per-thread buffer for stdout, flushed when the thread (or process) exits
+  static OutputBuffer& standardOutput();
+
+  void write(std::string_view text);
+  void write(const RopeString& text);
+  void write(int64_t value);
+  void write(double value);
+  void write(bool value);
+  void write(const Value& value);
+  void endLine();
+  void flush();
+
+  bool isLineBuffered() const { return lineBuffered; }
+
+private:
+  int fd;
+  bool lineBuffered;
+  size_t capacity;
+  size_t used = 0;
+  std::unique_ptr<char[]> buffer;
+
+  char* reserve(size_t size);
+  void writeAll(const char* data, size_t size);
+};
+
+//Runtime entry point for KEYWORD_PRINT: the value followed by a newline
+void printValue(const Value& value);
+void flushOutput();
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef PEBAS_PROFILER_H
+#define PEBAS_PROFILER_H
+
+#include <atomic>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <ostream>
+#include "pebas/ast/ast.h"
+
+namespace pebas {
+
+//One pebas frame: the function being run (nullptr for top-level code)
+//and the source line currently executing in it
+struct ProfileFrame {
+  const FunctionDecl* function;
+  int line;
+};
+
+//Shadow call stack kept by the VM so the profiler can see pebas frames.
+//Writes are ordered with signal fences so the SIGPROF handler, which runs
+//on the same thread, always reads complete frames.
+class CallStack {
+public:
+  static constexpr int MAX_DEPTH = 1024;
+
+  void push(const FunctionDecl* function, int line);
+  void pop();
+  void setLine(int line);
+
+  int getDepth() const { return depth.load(std::memory_order_relaxed); }
+  ProfileFrame getFrame(int index) const;
+
+private:
+  const FunctionDecl* functions[MAX_DEPTH];
+  std::atomic<int> lines[MAX_DEPTH];
+  std::atomic<int> depth{0};
+};
+
+//SIGPROF-driven sampling profiler.
+//The handler aggregates in place: each distinct stack is copied into
+//preallocated buffers once and then only has its count bumped, so a long
+//run keeps every sample. A sample whose stack is new and no longer fits
+//(maxStacks distinct stacks or maxFrames frames) is counted as dropped.
+//Only one profiler can be running at a time.
+//start() and stop() must be called on the VM thread that owns the call
+//stack: the timer counts that thread's CPU time and signals only it.
+class Profiler {
+public:
+  static constexpr int MAX_SAMPLE_DEPTH = 128;
+
+  Profiler(const CallStack& stack, int frequency = 1000,
+           size_t maxStacks = 1 << 16, size_t maxFrames = 1 << 20);
+  ~Profiler();
+
+  bool start();
+  void stop();
+
+  size_t getSampleCount() const { return sampleCount.load(std::memory_order_relaxed); }
+  size_t getStackCount() const { return stackCount.load(std::memory_order_acquire); }
+  size_t getDroppedCount() const { return droppedCount.load(std::memory_order_relaxed); }
+
+  //Brendan Gregg's collapsed stacks: "main:3;fib:10;fib:12 42"
+  void writeCollapsed(std::ostream& out) const;
+  //Uncompressed profile.proto, readable by `go tool pprof`
+  void writePprof(std::ostream& out) const;
+
+private:
+  //One distinct stack and how many samples hit it
+  struct Stack {
+    size_t firstFrame;
+    int depth; //frames are stored leaf first
+    uint64_t hash;
+    std::atomic<size_t> count{0};
+  };
+
+  const CallStack& stack;
+  int frequency;
+  size_t maxStacks;
+  size_t maxFrames;
+  std::unique_ptr<Stack[]> stacks;
+  std::unique_ptr<ProfileFrame[]> frames;
+  //Open-addressed index of `stacks` by hash: slot holds index + 1, 0 is empty
+  size_t slotMask;
+  std::unique_ptr<size_t[]> slots;
+  std::atomic<size_t> stackCount{0};
+  std::atomic<size_t> sampleCount{0};
+  std::atomic<size_t> droppedCount{0};
+  size_t frameCount = 0;
+  bool running = false;
+  timer_t timer;
+  struct sigaction previousAction;
+
+  static std::atomic<Profiler*> active;
+  static void handleSignal(int signal);
+  void takeSample();
+  bool sameStack(const Stack& entry, int depth, int kept) const;
+};
+
+}
+
+#endif
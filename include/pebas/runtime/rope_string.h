@@ -0,0 +1,78 @@
+#ifndef PEBAS_ROPE_STRING_H
+#define PEBAS_ROPE_STRING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace pebas {
+
+//Runtime string value (24 bytes).
+//Short strings live inline with no heap allocation. Long concatenations
+//are kept as a lazy rope and flattened once, the first time the bytes
+//are needed (indexing, comparison, print), so building a string with
+//repeated `+` is linear instead of quadratic.
+//Flattening caches into the shared node, so a rope must not be read
+//from several threads at once.
+class RopeString {
+public:
+  static constexpr size_t INLINE_CAPACITY = 22;
+  //Concatenations up to this size are copied flat; a rope node would cost more
+  static constexpr size_t FLAT_LIMIT = 128;
+
+  RopeString();
+  RopeString(std::string_view text);
+  RopeString(const RopeString& other);
+  RopeString(RopeString&& other) noexcept;
+  RopeString& operator=(RopeString other) noexcept;
+  ~RopeString();
+
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+  bool isInline() const { return tag != HEAP_TAG; }
+  //A concatenation that has not been flattened yet
+  bool isRope() const;
+
+  //Flattens a pending rope; the view stays valid while this value lives
+  std::string_view view() const;
+  std::string str() const { return std::string(view()); }
+  char at(size_t index) const;
+
+  friend RopeString operator+(const RopeString& left, const RopeString& right);
+  friend bool operator==(const RopeString& left, const RopeString& right);
+  friend bool operator!=(const RopeString& left, const RopeString& right) { return !(left == right); }
+
+private:
+  struct Node;
+
+  static constexpr uint8_t HEAP_TAG = 0xFF;
+
+  //Inline bytes, or the Node pointer when tag == HEAP_TAG.
+  //Kept as plain bytes so the value stays at 24 bytes.
+  char small[INLINE_CAPACITY + 1];
+  uint8_t tag; //inline length, or HEAP_TAG
+
+  explicit RopeString(Node* node);
+  Node* heapNode() const;
+  void swap(RopeString& other) noexcept;
+  static void release(Node* node);
+  static void flatten(Node* node);
+};
+
+//Interning hook for STRING literals: equal literals share one heap copy,
+//so comparing them is a pointer check.
+class StringInterner {
+public:
+  RopeString intern(std::string_view text);
+  size_t size() const { return strings.size(); }
+
+private:
+  //keys point into the flat bytes owned by the mapped value
+  std::unordered_map<std::string_view, RopeString> strings;
+};
+
+}
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef PEBAS_SNAPSHOT_H
+#define PEBAS_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "pebas/lexer/lexer.h"
+
+namespace pebas {
+
+//Snapshot images cache the front-end output of a set of modules (their
+//token streams).
+//Images are relocatable: every reference is an offset from the start of the
+//file, so a process mmaps the image and reads it in place. An image is a
+//machine-local cache; a module is only reused while its source hash matches.
+class SnapshotImage;
+
+class SnapshotWriter {
+public:
+  void addModule(const std::string& name, const std::string& source, const std::vector<Token>& tokens);
+  //Copies every module of `image` except `replaced`, so refreshing one
+  //module keeps the rest of a shared image
+  void addImage(const SnapshotImage& image, const std::string& replaced);
+
+  //Writes to a uniquely named temporary file and renames it, so readers never
+  //see a partial image. A new image is readable by its owner only; a
+  //refreshed one keeps the mode of the image it replaces.
+  bool write(const std::string& path) const;
+
+private:
+  struct Module {
+    std::string name;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    std::vector<Token> tokens;
+  };
+
+  std::vector<Module> modules;
+};
+
+class SnapshotImage {
+public:
+  //Returns nullptr if the file is missing, truncated, or written by another
+  //image format or lexer revision
+  static std::unique_ptr<SnapshotImage> open(const std::string& path);
+  ~SnapshotImage();
+
+  SnapshotImage(const SnapshotImage&) = delete;
+  SnapshotImage& operator=(const SnapshotImage&) = delete;
+
+  //Index of the module recorded for `name` with exactly this source, or -1
+  int findModule(const std::string& name, const std::string& source) const;
+  std::vector<Token> getTokens(int module) const;
+
+private:
+  friend class SnapshotWriter;
+
+  const char* base;
+  size_t size;
+
+  SnapshotImage(const char* base, size_t size) : base(base), size(size) {}
+  bool validate() const;
+  std::string_view text(uint64_t offset, uint64_t length) const;
+};
+
+uint64_t hashSource(std::string_view source);
+
+}
+
+#endif
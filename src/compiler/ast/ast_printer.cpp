@@ -0,0 +1,189 @@
+#include "pebas/ast/ast_printer.h"
+
+namespace pebas {
+
+const char* nodeTypeName(NodeType type) {
+  switch (type) {
+    case NodeType::LITERAL: return "LITERAL";
+    case NodeType::IDENTIFIER: return "IDENTIFIER";
+    case NodeType::UNARY: return "UNARY";
+    case NodeType::BINARY: return "BINARY";
+    case NodeType::GROUPING: return "GROUPING";
+    case NodeType::CALL: return "CALL";
+    case NodeType::MEMBER_ACCESS: return "MEMBER_ACCESS";
+    case NodeType::ARRAY_ACCESS: return "ARRAY_ACCESS";
+    case NodeType::ASSIGNMENT: return "ASSIGNMENT";
+    case NodeType::VARIABLE_DECL: return "VARIABLE_DECL";
+    case NodeType::FUNCTION: return "FUNCTION";
+    case NodeType::CLASS: return "CLASS";
+    case NodeType::INTERFACE: return "INTERFACE";
+    case NodeType::ENUM: return "ENUM";
+    case NodeType::STRUCT: return "STRUCT";
+    case NodeType::IMPORT: return "IMPORT";
+    case NodeType::BLOCK: return "BLOCK";
+    case NodeType::IF: return "IF";
+    case NodeType::WHILE: return "WHILE";
+    case NodeType::FOR: return "FOR";
+    case NodeType::FOR_RANGE: return "FOR_RANGE";
+    case NodeType::RETURN: return "RETURN";
+    case NodeType::PRINT: return "PRINT";
+    case NodeType::EXPRESSION_STMT: return "EXPRESSION_STMT";
+  }
+  return "UNKNOWN";
+}
+
+static std::string literalText(const LiteralExpr* literal) {
+  switch (literal->getLocationType()) {
+    case TokenType::STRING: return "\"" + literal->getStringValue() + "\"";
+    case TokenType::INTERGER_LITERAL: return std::to_string(literal->getIntValue());
+    case TokenType::FLOAT_LITERAL: return std::to_string(literal->getFloatValue());
+    case TokenType::CHAR_LITERAL: return "'" + std::string(1, static_cast<char>(literal->getIntValue())) + "'";
+    case TokenType::KEYWORD_TRUE: return "true";
+    case TokenType::KEYWORD_FALSE: return "false";
+    case TokenType::KEYWORD_NULL: return "null";
+    default: return tokenTypeName(literal->getLocationType());
+  }
+}
+
+void AstPrinter::print(const Program& program) {
+  for (const auto& statement : program.getStatements()) {
+    print(statement.get(), 0);
+  }
+}
+
+void AstPrinter::line(const ASTNode* node, int depth, const std::string& details) {
+  out << std::string(depth * 2, ' ') << nodeTypeName(node->getType());
+  if (!details.empty()) out << ' ' << details;
+  out << " @ " << node->getLocation().to_string() << '\n';
+}
+
+void AstPrinter::print(const ASTNode* node, int depth) {
+  if (!node) return;
+
+  switch (node->getType()) {
+    case NodeType::LITERAL:
+      line(node, depth, literalText(static_cast<const LiteralExpr*>(node)));
+      break;
+
+    case NodeType::IDENTIFIER:
+      line(node, depth, static_cast<const IdentifierExpr*>(node)->getName());
+      break;
+
+    case NodeType::UNARY: {
+      auto unary = static_cast<const UnaryExpr*>(node);
+      line(node, depth, tokenTypeName(unary->getOperator()));
+      print(unary->getOperand(), depth + 1);
+      break;
+    }
+
+    case NodeType::BINARY: {
+      auto binary = static_cast<const BinaryExpr*>(node);
+      line(node, depth, tokenTypeName(binary->getOperator()));
+      print(binary->getLeft(), depth + 1);
+      print(binary->getRight(), depth + 1);
+      break;
+    }
+
+    case NodeType::CALL: {
+      auto call = static_cast<const CallExpr*>(node);
+      line(node, depth, std::to_string(call->getArguments().size()) + " arguments");
+      print(call->getCallee(), depth + 1);
+      for (const auto& argument : call->getArguments()) {
+        print(argument.get(), depth + 1);
+      }
+      break;
+    }
+
+    case NodeType::ASSIGNMENT: {
+      auto assignment = static_cast<const AssignExpr*>(node);
+      line(node, depth, assignment->getName());
+      print(assignment->getValue(), depth + 1);
+      break;
+    }
+
+    case NodeType::EXPRESSION_STMT:
+      line(node, depth, "");
+      print(static_cast<const ExpressionStmt*>(node)->getExpression(), depth + 1);
+      break;
+
+    case NodeType::IF: {
+      auto branch = static_cast<const IfStmt*>(node);
+      line(node, depth, branch->getElseBranch() ? "with else" : "");
+      print(branch->getCondition(), depth + 1);
+      print(branch->getThenBranch(), depth + 1);
+      print(branch->getElseBranch(), depth + 1);
+      break;
+    }
+
+    case NodeType::WHILE: {
+      auto loop = static_cast<const WhileStmt*>(node);
+      line(node, depth, "");
+      print(loop->getCondition(), depth + 1);
+      print(loop->getBody(), depth + 1);
+      break;
+    }
+
+    case NodeType::RETURN:
+      line(node, depth, "");
+      print(static_cast<const ReturnStmt*>(node)->getValue(), depth + 1);
+      break;
+
+    case NodeType::PRINT:
+      line(node, depth, "");
+      print(static_cast<const PrintStmt*>(node)->getValue(), depth + 1);
+      break;
+
+    case NodeType::BLOCK:
+      line(node, depth, "");
+      for (const auto& statement : static_cast<const BlockStmt*>(node)->getStatements()) {
+        print(statement.get(), depth + 1);
+      }
+      break;
+
+    case NodeType::VARIABLE_DECL: {
+      auto variable = static_cast<const VariableDecl*>(node);
+      std::string details = variable->getName();
+      if (variable->getTypeName()) details += ": " + *variable->getTypeName();
+      line(node, depth, details);
+      print(variable->getInitializer(), depth + 1);
+      break;
+    }
+
+    case NodeType::FUNCTION: {
+      auto function = static_cast<const FunctionDecl*>(node);
+      std::string details = function->getName() + "(";
+      const auto& parameters = function->getParameters();
+      for (size_t i = 0; i < parameters.size(); i++) {
+        if (i > 0) details += ", ";
+        details += parameters[i].name + ": " + parameters[i].type_name;
+      }
+      details += ")";
+      if (function->getReturntype()) details += " -> " + *function->getReturntype();
+      line(node, depth, details);
+      print(function->getBody(), depth + 1);
+      if (!function->getBodyError().empty()) {
+        out << std::string((depth + 1) * 2, ' ') << "ERROR " << function->getBodyError() << '\n';
+      }
+      break;
+    }
+
+    case NodeType::IMPORT:
+      line(node, depth, "\"" + static_cast<const ImportDecl*>(node)->getPath() + "\"");
+      break;
+
+    case NodeType::FOR_RANGE: {
+      auto loop = static_cast<const ForRangeStmt*>(node);
+      line(node, depth, loop->getVariable() + " in range");
+      print(loop->getStart(), depth + 1);
+      print(loop->getEnd(), depth + 1);
+      print(loop->getBody(), depth + 1);
+      break;
+    }
+
+    default:
+      line(node, depth, "");
+      break;
+  }
+}
+
+}
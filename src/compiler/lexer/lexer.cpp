@@ -1,16 +1,25 @@
 #include "pebas/lexer/lexer.h"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <thread>
 #include <unordered_map>
 
 namespace pebas {
 Lexer::Lexer(const std::string& source, const std::string& filename)
-    : source(source), filename(filename), start(0), current(0), line(0), column(1) {}
+    : source(source), filename(filename), start(0), current(0), line(1), column(1) {}
+
+//Chunk lexer for tokenizerParallel(); chunks always begin at the start of a line
+Lexer::Lexer(const std::string& source, const std::string& filename, size_t begin, int line)
+    : source(source), filename(filename), start(begin), current(begin), line(line), column(1) {}
 
 Token Lexer::nextToken() {
   skipWhitespace();
 
   start = current;
 
-  if (isAtEnd()) return makeToken(TokenType::EOF_TOKEN);
+  if (isAtEnd()) return makeToken(TokenType::TOKEN_EOF);
 
   char c = advance();
 
@@ -21,13 +30,13 @@ Token Lexer::nextToken() {
       skipComment();
       return nextToken();
     } else { //single line comment 
-      while (peek() != '\n' && !isAtEnd()) avdvance();
+      while (peek() != '\n' && !isAtEnd()) advance();
       return nextToken();
     }
   }
 
   if (isAlpha(c)) return identifier();
-?\
+
   if(isDigit(c)) return number();
 
   if(c == '"') return string();
@@ -36,34 +45,37 @@ Token Lexer::nextToken() {
 
   switch (c) {
     case '(': return makeToken(TokenType::LEFT_PAREN);
-    case ')': return makeToken(TokenType::RIGTH_PAREN);
+    case ')': return makeToken(TokenType::RIGHT_PAREN);
     case '{': return makeToken(TokenType::LEFT_BRACE);
-    case '}': return makeToken(TokenType::RIGTH_BRACE);
+    case '}': return makeToken(TokenType::RIGHT_BRACE);
     case '[': return makeToken(TokenType::LEFT_BRACKET);
-    case ']': return makeToken(TokenType::RIGTH_BRACKET);
+    case ']': return makeToken(TokenType::RIGHT_BRACKET);
     case ';': return makeToken(TokenType::SEMICOLON);
-    case ':': return makeToken(TokenType:COLON);
-    case ',': return makeToken(TokenType:COMMA);
-    case '.': return makeToken(TokenType:DOT);
+    case ':': return makeToken(TokenType::COLON);
+    case ',': return makeToken(TokenType::COMMA);
+    case '.':
+        return match('.') ?
+              makeToken(TokenType::DOT_DOT) :
+               makeToken(TokenType::DOT);
 
       //Operators that can be combined
-    case '+': return makeToKen(TokenType::PLUS);
+    case '+': return makeToken(TokenType::PLUS);
     case '-':
         return peek() == '>' ?
-              (advance(), makeToken(TokenType::ARROW)) :
+              (advance(), makeToken(TokenType::ARROW_RIGHT)) :
                makeToken(TokenType::MINUS);
-    case '*': return makeToken(TokenType::MULTIPLY);
-    case '/': return makeToken(TokenType::DIVIDE);
+    case '*': return makeToken(TokenType::STAR);
+    case '/': return makeToken(TokenType::SLASH);
 
     case '=':
         return match('=') ?
-              makeToken(TokenType::EQUAL) :
-               makeToken(TokenType::ASSIGN);
+              makeToken(TokenType::EQUAL_EQUAL) :
+               makeToken(TokenType::EQUAL);
     
     case '!':
         return match('=') ?
-              makeToken(TokenType::LESS_EQUAL) :
-               makeToken(TokenType::NOT);
+              makeToken(TokenType::BANG_EQUAL) :
+               makeToken(TokenType::BANG);
 
     case '<':
         return match('=') ?
@@ -76,11 +88,11 @@ Token Lexer::nextToken() {
                makeToken(TokenType::GREATER);
     
     case '&':
-      if (match('&')) return makeToken(TokenType::AND);
+      if (match('&')) return makeToken(TokenType::AND_AND);
       break;
  
     case '|':
-      if (match('|')) return makeToken(TokenType::OR);
+      if (match('|')) return makeToken(TokenType::OR_OR);
       break;
 
   }
@@ -94,7 +106,7 @@ std::vector<Token> Lexer::tokenizer() {
     Token token = nextToken();
     tokens.push_back(token);
 
-    if (token.type == TokenType::EOF_TOKEN){
+    if (token.type == TokenType::TOKEN_EOF){
       break;
     }
   }
@@ -102,6 +114,172 @@ std::vector<Token> Lexer::tokenizer() {
   return tokens;
 }
 
+//Lexes the tokens that start before `end`. A string or comment that began
+//in the previous chunk is skipped, since the previous chunk's lexer already
+//ran past its own end to finish it.
+std::vector<Token> Lexer::tokenizeChunk(size_t end, LexState entry) {
+  std::vector<Token> tokens;
+
+  if (entry == LexState::BLOCK_COMMENT) skipComment();
+  if (entry == LexState::STRING) skipString();
+
+  while (true) {
+    Token token = nextToken();
+
+    if (token.type == TokenType::TOKEN_EOF) {
+      if (end == source.length()) tokens.push_back(token);
+      break;
+    }
+    if (start >= end) break;
+
+    tokens.push_back(token);
+  }
+
+  return tokens;
+}
+
+//Replays only the lexer decisions that can carry over a line break
+//(strings, block comments, char literals, line comments) and returns the
+//state the lexer is in when it reaches `end`.
+LexState Lexer::scanChunk(const std::string& source, size_t begin, size_t end, LexState entry) {
+  const size_t length = source.length();
+  LexState state = entry;
+  size_t i = begin;
+
+  while (i < end) {
+    char c = source[i];
+
+    if (state == LexState::BLOCK_COMMENT) {
+      if (c == '*' && i + 1 < length && source[i + 1] == '#') {
+        state = LexState::NORMAL;
+        i += 2;
+      } else {
+        i++;
+      }
+    } else if (state == LexState::STRING) {
+      if (c == '"') {
+        state = LexState::NORMAL;
+        i++;
+      } else if (c == '\\' && i + 1 < length && source[i + 1] == '"') {
+        i += 2;
+      } else {
+        i++;
+      }
+    } else if (c == '#') {
+      if (i + 1 < length && source[i + 1] == '*') {
+        state = LexState::BLOCK_COMMENT;
+        i += 2;
+      } else {
+        const void* newline = std::memchr(source.data() + i, '\n', end - i);
+        i = newline ? static_cast<const char*>(newline) - source.data() : end;
+      }
+    } else if (c == '"') {
+      state = LexState::STRING;
+      i++;
+    } else if (c == '\'') {
+      i += (i + 1 < length && source[i + 1] == '\\') ? 3 : 2;
+      if (i < length && source[i] == '\'') i++;
+    } else {
+      i++;
+    }
+  }
+
+  return state;
+}
+
+std::vector<Token> Lexer::tokenizerParallel(unsigned threads, size_t minChunk) {
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+  const size_t length = source.length() - current;
+  size_t wanted = std::min<size_t>(threads, length / std::max<size_t>(minChunk, 1));
+  if (wanted <= 1) return tokenizer();
+
+  //Chunks start right after a newline, where every token has ended unless
+  //the lexer is inside a string or block comment. A newline followed by a
+  //quote could still be inside a char literal, so it is not used.
+  std::vector<size_t> bounds = {current};
+  for (size_t i = 1; i < wanted; i++) {
+    size_t target = std::max(current + length / wanted * i, bounds.back() + 1);
+    while (target < source.length()) {
+      const void* found = std::memchr(source.data() + target, '\n', source.length() - target);
+      if (!found) {
+        target = source.length();
+        break;
+      }
+      target = static_cast<const char*>(found) - source.data() + 1;
+      if (target < source.length() && source[target] != '\'') break;
+    }
+    if (target >= source.length()) break;
+    bounds.push_back(target);
+  }
+  bounds.push_back(source.length());
+
+  const size_t chunks = bounds.size() - 1;
+  if (chunks <= 1) return tokenizer();
+
+  //Pass 1: exit state of every chunk for each possible entry state, and its line count
+  std::vector<LexState> exits(chunks * 3);
+  std::vector<int> newlines(chunks);
+  std::vector<std::thread> workers;
+
+  for (size_t k = 0; k < chunks; k++) {
+    workers.emplace_back([&, k]() {
+      size_t begin = bounds[k];
+      size_t end = bounds[k + 1];
+      for (int entry = 0; entry < 3; entry++) {
+        if (k == 0 && entry != static_cast<int>(LexState::NORMAL)) continue;
+        exits[k * 3 + entry] = scanChunk(source, begin, end, static_cast<LexState>(entry));
+      }
+      newlines[k] = static_cast<int>(std::count(source.begin() + begin, source.begin() + end, '\n'));
+    });
+  }
+  for (auto& worker : workers) worker.join();
+  workers.clear();
+
+  //Pass 2: pick the consistent entry state and first line of each chunk
+  std::vector<LexState> entries(chunks);
+  std::vector<int> lines(chunks);
+  entries[0] = LexState::NORMAL;
+  lines[0] = line;
+  for (size_t k = 1; k < chunks; k++) {
+    entries[k] = exits[(k - 1) * 3 + static_cast<int>(entries[k - 1])];
+    lines[k] = lines[k - 1] + newlines[k - 1];
+  }
+
+  //Pass 3: lex every chunk from its real state
+  std::vector<std::vector<Token>> results(chunks);
+  std::vector<std::exception_ptr> errors(chunks);
+
+  for (size_t k = 0; k < chunks; k++) {
+    workers.emplace_back([&, k]() {
+      try {
+        Lexer chunk(source, filename, bounds[k], lines[k]);
+        if (k == 0) chunk.column = column;
+        results[k] = chunk.tokenizeChunk(bounds[k + 1], entries[k]);
+      } catch (...) {
+        errors[k] = std::current_exception();
+      }
+    });
+  }
+  for (auto& worker : workers) worker.join();
+
+  for (const auto& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+
+  size_t total = 0;
+  for (const auto& result : results) total += result.size();
+
+  std::vector<Token> tokens;
+  tokens.reserve(total);
+  for (auto& result : results) {
+    std::move(result.begin(), result.end(), std::back_inserter(tokens));
+  }
+
+  current = source.length();
+  return tokens;
+}
+
 //Auxiliary methods
 char Lexer::peek() const {
   if (isAtEnd()) return '\0';
@@ -118,7 +296,7 @@ char Lexer::advance() {
     line++;
     column = 1;
   } else {
-    column++
+    column++;
   }
   return source[current++];
 }
@@ -138,10 +316,10 @@ bool Lexer::isAtEnd() const {
 }
 
 bool Lexer::isDigit(char c) const {
-  return c >= '0' && <= '9';
+  return c >= '0' && c <= '9';
 }
 
-bool lexer"::isAlpha(char c) const {
+bool Lexer::isAlpha(char c) const {
   return (c >= 'a' && c <= 'z') ||
          (c >= 'A'&& c <= 'Z') ||
           c == '_';
@@ -155,15 +333,11 @@ void Lexer::skipWhitespace() {
   while (true) {
     char c = peek();
 
-    swift (c) {
+    switch (c) {
       case ' ' :
       case '\t':
       case '\r':
-          advance()';
-          break;
-      case '\n':
-          line++;
-          column = 1;
+      case '\n': //advance() keeps line and column up to date
           advance();
           break;
         default:
@@ -176,10 +350,6 @@ void Lexer::skipComment() {
   //Read until "*#"is found (close multi-line comment)
 
   while (!(peek() == '*' && peekNext() == '#') && !isAtEnd()) {
-      if (peek() == '\n') {
-          line++;
-          column = 1;
-}
       advance();
 }
   if (!isAtEnd()){
@@ -203,40 +373,43 @@ Token Lexer::identifier() {
   return makeToken(type);
 }
 
-Token lexer::number() {
+Token Lexer::number() {
   while (isDigit(peek())) advance();
 
-  if(peek() == '.' && isDigit(peek())) {
+  if(peek() == '.' && isDigit(peekNext())) {
     advance();
 
     while (isDigit(peek())) advance();
 
-    Token token = makeToken(TokenType::FLOAT);
+    Token token = makeToken(TokenType::FLOAT_LITERAL);
     std::string value = source.substr(start, current - start);
     token.floatValue = std::stod(value);
     return token;
   }
 
-  Token token = makeToken(TokenType::INTEGER);
+  Token token = makeToken(TokenType::INTERGER_LITERAL);
   std::string value = source.substr(start, current - start);
   token.intValue = std::stoi(value);
   return token;
 }
-Token Lexer::string() {
-  //Skip initial quote 
-  while (speek() != '"' && !isAtEnd()) {
-    if (peek() == '\n') {
-      line++';
-      column = 1;
-    }else if(peek() == '\\' && peekNext() == '"') {
+//Consumes a string body and its closing quote; false if it never closes
+bool Lexer::skipString() {
+  while (peek() != '"' && !isAtEnd()) {
+    if(peek() == '\\' && peekNext() == '"') {
       advance();
     }
     advance();
   }
 
-  if (isAtEnd()) return errorToken("Unterminated string.");
+  if (isAtEnd()) return false;
 
   advance();
+  return true;
+}
+
+Token Lexer::string() {
+  //Skip initial quote 
+  if (!skipString()) return errorToken("Unterminated string.");
 
   std::string value = source.substr(start + 1, current - start - 2);
   Token token = makeToken(TokenType::STRING);
@@ -246,18 +419,17 @@ Token Lexer::string() {
 
 Token Lexer::character(){
 
-  if(peek() == '\\') {
-    advance();
-    advance();
-  } else {
-    advance();
-  }
+  if(peek() == '\\') advance();
 
-  if (peek() != '\'') return errorToken("Expected '\\'' to close character.")
-    advance();
+  //a literal cut off by the end of the file must not read past it
+  if (isAtEnd()) return errorToken("Unterminated character.");
+  advance();
+
+  if (peek() != '\'') return errorToken("Expected '\\'' to close character.");
+  advance();
 
-  std::string value = source.substr(star +1, current - start - 2);
-  Token token = makeToken(TokenType::CHAR);
+  std::string value = source.substr(start + 1, current - start - 2);
+  Token token = makeToken(TokenType::CHAR_LITERAL);
   token.intValue = value[0]; //Store the ASCII code the character 
   return token;
 }
@@ -270,38 +442,40 @@ Token Lexer::makeToken(TokenType type) {
 
 Token Lexer::errorToken(const std::string& message) {
   SourceLocation loc(filename, line, column - (current - start));
-  return Token(TokenType::ERROR, message, loc);
+  return Token(TokenType::TOKEN_ERROR, message, loc);
 }
 
 TokenType Lexer::identifierType() {
   static const std::unordered_map<std::string, TokenType> keywords = {
-    {"class", TokenType::CLASS},
-    {"interface", TokenType::INTERFACE},
-    {"enum", TokenType::ENUM},
-    {"struct", TokenType::STRUCT},
-    {"function", TokenType::FUNCTION},
-    {"var", TokenType::VAR},
-    {"const", TokenType::CONST},
-    {"if", TokenType::IF},
-    {"else", TokenType::ELSE},
-    {"switch", TokenType::SWITCH},
-    {"case", TokenType::CASE},
-    {"for", TokenType::FOR},
-    {"while", TokenType::WHILE},
-    {"do", TokenType::DO},
-    {"break", TokenType::BREAK},
-    {"continue", TokenType::CONTINUE},
-    {"return", TokenType::RETURN},
-    {"try", TokenType::TRY},
-    {"catch", TokenType::CATCH},
-    {"throw", TokenType::THROW},
-    {"public", TokenType::PUBLIC},
-    {"private", TokenType::PRIVATE},
-    {"protected", TokenType::PROTECTED},
-    {"static", TokenType::STATIC},
-    {"true", TokenType::TRUE},
-    {"null", TokenType::NULL},
-    {"false", TokenType::FALSE}
+    {"class", TokenType::KEYWORD_CLASS},
+    {"interface", TokenType::KEYWORD_INTERFACE},
+    {"enum", TokenType::KEYWORD_ENUM},
+    {"struct", TokenType::KEYWORD_STRUCT},
+    {"function", TokenType::KEYWORD_FUNCTION},
+    {"var", TokenType::KEYWORD_VAR},
+    {"const", TokenType::KEYWORD_CONST},
+    {"if", TokenType::KEYWORD_IF},
+    {"else", TokenType::KEYWORD_ELSE},
+    {"switch", TokenType::KEYWORD_SWITCH},
+    {"case", TokenType::KEYWORD_CASE},
+    {"for", TokenType::KEYWORD_FOR},
+    {"while", TokenType::KEYWORD_WHILE},
+    {"do", TokenType::KEYWORD_DO},
+    {"break", TokenType::KEYWORD_BREAK},
+    {"continue", TokenType::KEYWORD_CONTINUE},
+    {"return", TokenType::KEYWORD_RETURN},
+    {"try", TokenType::KEYWORD_TRY},
+    {"catch", TokenType::KEYWORD_CATCH},
+    {"throw", TokenType::KEYWORD_THROW},
+    {"public", TokenType::KEYWORD_PUBLIC},
+    {"private", TokenType::KEYWORD_PRIVATE},
+    {"protected", TokenType::KEYWORD_PROTECTED},
+    {"static", TokenType::KEYWORD_STATIC},
+    {"import", TokenType::KEYWORD_IMPORT},
+    {"print", TokenType::KEYWORD_PRINT},
+    {"true", TokenType::KEYWORD_TRUE},
+    {"null", TokenType::KEYWORD_NULL},
+    {"false", TokenType::KEYWORD_FALSE}
     
   };
 
@@ -314,5 +488,107 @@ TokenType Lexer::identifierType() {
   return TokenType::IDENTIFIER;
 }
 
+const char* tokenTypeName(TokenType type) {
+  switch (type) {
+    case TokenType::LEFT_PAREN: return "LEFT_PAREN";
+    case TokenType::RIGHT_PAREN: return "RIGHT_PAREN";
+    case TokenType::LEFT_BRACE: return "LEFT_BRACE";
+    case TokenType::RIGHT_BRACE: return "RIGHT_BRACE";
+    case TokenType::LEFT_BRACKET: return "LEFT_BRACKET";
+    case TokenType::RIGHT_BRACKET: return "RIGHT_BRACKET";
+    case TokenType::COMMA: return "COMMA";
+    case TokenType::DOT: return "DOT";
+    case TokenType::MINUS: return "MINUS";
+    case TokenType::PLUS: return "PLUS";
+    case TokenType::SEMICOLON: return "SEMICOLON";
+    case TokenType::SLASH: return "SLASH";
+    case TokenType::STAR: return "STAR";
+    case TokenType::COLON: return "COLON";
+    case TokenType::QUESTION: return "QUESTION";
+    case TokenType::PERCENT: return "PERCENT";
+    case TokenType::TILDE: return "TILDE";
+    case TokenType::AMPERSAND: return "AMPERSAND";
+    case TokenType::PIPE: return "PIPE";
+    case TokenType::CARET: return "CARET";
+    case TokenType::BANG: return "BANG";
+    case TokenType::BANG_EQUAL: return "BANG_EQUAL";
+    case TokenType::EQUAL: return "EQUAL";
+    case TokenType::EQUAL_EQUAL: return "EQUAL_EQUAL";
+    case TokenType::GREATER: return "GREATER";
+    case TokenType::GREATER_EQUAL: return "GREATER_EQUAL";
+    case TokenType::LESS: return "LESS";
+    case TokenType::LESS_EQUAL: return "LESS_EQUAL";
+    case TokenType::PLUS_ASSIGN: return "PLUS_ASSIGN";
+    case TokenType::MINUS_ASSIGN: return "MINUS_ASSIGN";
+    case TokenType::STAR_ASSIGN: return "STAR_ASSIGN";
+    case TokenType::PERCENT_ASSIGN: return "PERCENT_ASSIGN";
+    case TokenType::AMPERSAND_ASSIGN: return "AMPERSAND_ASSIGN";
+    case TokenType::PIPE_ASSIGN: return "PIPE_ASSIGN";
+    case TokenType::CARET_ASSIGN: return "CARET_ASSIGN";
+    case TokenType::LESS_LESS_ASSIGN: return "LESS_LESS_ASSIGN";
+    case TokenType::GREATER_GREATER_ASSIGN: return "GREATER_GREATER_ASSIGN";
+    case TokenType::AND_AND: return "AND_AND";
+    case TokenType::OR_OR: return "OR_OR";
+    case TokenType::ARROW_RIGHT: return "ARROW_RIGHT";
+    case TokenType::DOUBLE_ARROW_RIGHT: return "DOUBLE_ARROW_RIGHT";
+    case TokenType::COLON_COLON: return "COLON_COLON";
+    case TokenType::DOT_DOT: return "DOT_DOT";
+    case TokenType::IDENTIFIER: return "IDENTIFIER";
+    case TokenType::STRING: return "STRING";
+    case TokenType::INTERGER_LITERAL: return "INTERGER_LITERAL";
+    case TokenType::FLOAT_LITERAL: return "FLOAT_LITERAL";
+    case TokenType::CHAR_LITERAL: return "CHAR_LITERAL";
+    case TokenType::KEYWORD_CLASS: return "KEYWORD_CLASS";
+    case TokenType::KEYWORD_INTERFACE: return "KEYWORD_INTERFACE";
+    case TokenType::KEYWORD_ENUM: return "KEYWORD_ENUM";
+    case TokenType::KEYWORD_STRUCT: return "KEYWORD_STRUCT";
+    case TokenType::KEYWORD_FUNCTION: return "KEYWORD_FUNCTION";
+    case TokenType::KEYWORD_VAR: return "KEYWORD_VAR";
+    case TokenType::KEYWORD_CONST: return "KEYWORD_CONST";
+    case TokenType::KEYWORD_PUBLIC: return "KEYWORD_PUBLIC";
+    case TokenType::KEYWORD_PRIVATE: return "KEYWORD_PRIVATE";
+    case TokenType::KEYWORD_PROTECTED: return "KEYWORD_PROTECTED";
+    case TokenType::KEYWORD_STATIC: return "KEYWORD_STATIC";
+    case TokenType::KEYWORD_ABSTRACT: return "KEYWORD_ABSTRACT";
+    case TokenType::KEYWORD_OVERRIDE: return "KEYWORD_OVERRIDE";
+    case TokenType::KEYWORD_VIRTUAL: return "KEYWORD_VIRTUAL";
+    case TokenType::KEYWORD_IMPORT: return "KEYWORD_IMPORT";
+    case TokenType::KEYWORD_PACKAGE: return "KEYWORD_PACKAGE";
+    case TokenType::KEYWORD_NEW: return "KEYWORD_NEW";
+    case TokenType::KEYWORD_THIS: return "KEYWORD_THIS";
+    case TokenType::KEYWORD_SUPER: return "KEYWORD_SUPER";
+    case TokenType::KEYWORD_AS: return "KEYWORD_AS";
+    case TokenType::KEYWORD_IS: return "KEYWORD_IS";
+    case TokenType::KEYWORD_IF: return "KEYWORD_IF";
+    case TokenType::KEYWORD_ELSE: return "KEYWORD_ELSE";
+    case TokenType::KEYWORD_SWITCH: return "KEYWORD_SWITCH";
+    case TokenType::KEYWORD_CASE: return "KEYWORD_CASE";
+    case TokenType::KEYWORD_FOR: return "KEYWORD_FOR";
+    case TokenType::KEYWORD_WHILE: return "KEYWORD_WHILE";
+    case TokenType::KEYWORD_DO: return "KEYWORD_DO";
+    case TokenType::KEYWORD_BREAK: return "KEYWORD_BREAK";
+    case TokenType::KEYWORD_CONTINUE: return "KEYWORD_CONTINUE";
+    case TokenType::KEYWORD_RETURN: return "KEYWORD_RETURN";
+    case TokenType::KEYWORD_TRY: return "KEYWORD_TRY";
+    case TokenType::KEYWORD_CATCH: return "KEYWORD_CATCH";
+    case TokenType::KEYWORD_THROW: return "KEYWORD_THROW";
+    case TokenType::KEYWORD_NULL: return "KEYWORD_NULL";
+    case TokenType::KEYWORD_TRUE: return "KEYWORD_TRUE";
+    case TokenType::KEYWORD_FALSE: return "KEYWORD_FALSE";
+    case TokenType::KEYWORD_PRINT: return "KEYWORD_PRINT";
+    case TokenType::TOKEN_ERROR: return "TOKEN_ERROR";
+    case TokenType::TOKEN_EOF: return "TOKEN_EOF";
+  }
+  return "UNKNOWN";
+}
+
+std::string SourceLocation::to_string() const {
+  return filename + ":" + std::to_string(line) + ":" + std::to_string(column);
+}
+
+std::string Token::to_string() const {
+  return location.to_string() + " " + tokenTypeName(type) + " '" + lexeme + "'";
+}
+
 
 }
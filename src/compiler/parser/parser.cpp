@@ -4,6 +4,9 @@ namespace pebas {
 
 Parser::Parser(const std::vector<Token>& tokens) : tokens(tokens) {}
 
+Parser::Parser(std::shared_ptr<const std::vector<Token>> sharedTokens)
+    : sharedTokens(sharedTokens), tokens(*sharedTokens), lazyBodies(true) {}
+
 std::unique_ptr<Program> Parser::parse() {
   std::vector<std::unique_ptr<Statement>> statements;
 
@@ -11,6 +14,7 @@ std::unique_ptr<Program> Parser::parse() {
     try {
       statements.push_back(declaration());
     } catch (const ParseError& error) {
+      errors.push_back(error);
       synchronize();
     }
   }
@@ -19,9 +23,9 @@ std::unique_ptr<Program> Parser::parse() {
 
 }
 
-// auxiliary methods 
+// auxiliary methods
 Token Parser::peek() const {
-  return tokens[current - 1];
+  return tokens[current];
 }
 
 Token Parser::previous() const {
@@ -29,9 +33,9 @@ Token Parser::previous() const {
 }
 
 bool Parser::isAtEnd() const {
-  return peek().type == TokenType::EOF_TOKEN;
+  return peek().type == TokenType::TOKEN_EOF;
 }
-  
+
 Token Parser::advance() {
   if (!isAtEnd()) current++;
   return previous();
@@ -61,7 +65,7 @@ bool Parser::match(std::initializer_list<TokenType> types) {
 }
 
 Token Parser::consume(TokenType type, const std::string& message) {
-  if (check(type) return advance());
+  if (check(type)) return advance();
   throw error(peek(), message);
 }
 
@@ -76,13 +80,15 @@ void Parser::synchronize() {
     if (previous().type == TokenType::SEMICOLON) return;
 
     switch (peek().type) {
-      case TokenType::CLASS:
-      case TokenType::FUNCTION:
-      case TokenType::VAR:
-      case TokenType::FOR:
-      case TokenType::IF:
-      case TokenType::WHILE:
-      case TokenType::RETURN:
+      case TokenType::KEYWORD_CLASS:
+      case TokenType::KEYWORD_FUNCTION:
+      case TokenType::KEYWORD_IMPORT:
+      case TokenType::KEYWORD_VAR:
+      case TokenType::KEYWORD_FOR:
+      case TokenType::KEYWORD_IF:
+      case TokenType::KEYWORD_WHILE:
+      case TokenType::KEYWORD_RETURN:
+      case TokenType::KEYWORD_PRINT:
           return;
       default:
           break;
@@ -92,122 +98,395 @@ void Parser::synchronize() {
 }
 
 std::unique_ptr<Statement> Parser::declaration() {
-  if (match(TokenType::VAR)) {
+  if (match(TokenType::KEYWORD_VAR)) {
     return varDeclaration();
   }
-  if (match(TokenType::FUNCTION)) {
+  if (match(TokenType::KEYWORD_FUNCTION)) {
     return functionDeclaration();
   }
+  if (match(TokenType::KEYWORD_IMPORT)) {
+    return importDeclaration();
+  }
 
   return statement();
 }
 
+std::unique_ptr<Statement> Parser::importDeclaration() {
+  Token path = consume(TokenType::STRING, "Expected module path after 'import'.");
+  consume(TokenType::SEMICOLON, "Expected ';' after import.");
+  return std::make_unique<ImportDecl>(path);
+}
+
 std::unique_ptr<Statement> Parser::varDeclaration() {
   Token name = consume(TokenType::IDENTIFIER, "Expected variable name.");
 
   std::optional<std::string> typeName;
   if (match(TokenType::COLON)) {
-    Token type = consume(TokenType::IDENTIFIER, "Expected type after '.'.");
+    Token type = consume(TokenType::IDENTIFIER, "Expected type after ':'.");
     typeName = type.lexeme;
   }
 
   std::unique_ptr<Expression> initializer = nullptr;
-  if (match(TokenType::ASSIGN)) {
+  if (match(TokenType::EQUAL)) {
     initializer = expression();
   }
 
-  consume(TokenTypeSEMICOLON, "Expected ';'after variable declaration.");
+  consume(TokenType::SEMICOLON, "Expected ';' after variable declaration.");
   return std::make_unique<VariableDecl>(name, typeName, std::move(initializer));
 }
 
+//Skips to the '}' that closes the current function body.
+//Bracket nesting and lexer errors are still checked, so the common syntax
+//errors are reported at startup without building the body.
+void Parser::skipFunctionBody() {
+  std::vector<TokenType> closers = {TokenType::RIGHT_BRACE};
+
+  while (!isAtEnd()) {
+    Token token = advance();
+
+    switch (token.type) {
+      case TokenType::LEFT_PAREN:
+        closers.push_back(TokenType::RIGHT_PAREN);
+        break;
+      case TokenType::LEFT_BRACKET:
+        closers.push_back(TokenType::RIGHT_BRACKET);
+        break;
+      case TokenType::LEFT_BRACE:
+        closers.push_back(TokenType::RIGHT_BRACE);
+        break;
+      case TokenType::RIGHT_PAREN:
+      case TokenType::RIGHT_BRACKET:
+      case TokenType::RIGHT_BRACE:
+        if (token.type != closers.back()) {
+          throw error(token, "Unbalanced '" + token.lexeme + "' in function body.");
+        }
+        closers.pop_back();
+        if (closers.empty()) return;
+        break;
+      case TokenType::TOKEN_ERROR:
+        throw error(token, token.lexeme);
+      default:
+        break;
+    }
+  }
+
+  throw error(peek(), "Expected '}' after block.");
+}
+
 std::unique_ptr<Statement> Parser::functionDeclaration() {
-  Token name = consume(TokenType::IDENTIFER, "Expected function name.")
-    consume(TokenType::LEFT_PAREN, "Expected '(' after function name.");
+  Token name = consume(TokenType::IDENTIFIER, "Expected function name.");
+  consume(TokenType::LEFT_PAREN, "Expected '(' after function name.");
 
-  std:vector<Parameter> parameters;
-  if (!check(Tokentype::RIGHT_PAREN)) {
+  std::vector<Parameter> parameters;
+  if (!check(TokenType::RIGHT_PAREN)) {
     do {
       Token paramName = consume(TokenType::IDENTIFIER, "Expected parameter name.");
       consume(TokenType::COLON, "Expected ':' after parameter name.");
       Token paramType = consume(TokenType::IDENTIFIER, "Expected parameter type." );
 
-      parameters.emplace_back(paramName.lexeme, paraType.lexeme, paramName.location);
+      parameters.emplace_back(paramName.lexeme, paramType.lexeme, paramName.location);
     } while (match(TokenType::COMMA));
   }
-  consume(TokenType::RIGTH_PAREN, "Expected parameter type.");
+  consume(TokenType::RIGHT_PAREN, "Expected ')' after parameters.");
 
   std::optional<std::string> returnType;
-  if (match(TokenType::ARROW)) {
+  if (match(TokenType::ARROW_RIGHT)) {
     Token type = consume(TokenType::IDENTIFIER, "Expected return type after '->'.");
     returnType = type.lexeme;
   }
 
   consume(TokenType::LEFT_BRACE, "Expected '{' before function body");
-  std::unique_ptr<BlockStmt> body = 
+
+  if (lazyBodies) {
+    //Only brace-match now; the body is built the first time it is needed
+    size_t open = current - 1;
+    skipFunctionBody();
+
+    //getBody() is a const getter, so a syntax error is recorded, not thrown
+    auto tokens = sharedTokens;
+    auto parseBody = [tokens, open](std::string& error) -> std::unique_ptr<BlockStmt> {
+      Parser parser(tokens);
+      parser.current = open + 1;
+      try {
+        return std::unique_ptr<BlockStmt>(static_cast<BlockStmt*>(parser.blockStatement().release()));
+      } catch (const ParseError& parseError) {
+        error = parseError.getLocation().to_string() + ": " + parseError.what();
+        return nullptr;
+      }
+    };
+
+    return std::make_unique<FunctionDecl>(name, std::move(parameters), returnType, parseBody);
+  }
+
+  std::unique_ptr<BlockStmt> body =
     std::unique_ptr<BlockStmt>(static_cast<BlockStmt*>(blockStatement().release()));
 
   return std::make_unique<FunctionDecl>(name, std::move(parameters), returnType, std::move(body));
+}
 
-  std::unique_ptr<Statement> Parser::statement() {
-    if (match(TokenType::IF)) {
-      return ifStatement();
-    }
-    if (match(TokenType::WHILE)){
-      return whileStatement();
-    }
-    if (match(TokenType::FOR)) {
-      return forStatement();
-    }
-    if (match(TokenType::RETURN)) {
-      return returnStatement();
-    }
-    if (match(TokenType::LEFT_BRACE)) {
-      return blockStatement();
-    }
-      return expressionStatement();
+std::unique_ptr<Statement> Parser::statement() {
+  if (match(TokenType::KEYWORD_IF)) {
+    return ifStatement();
+  }
+  if (match(TokenType::KEYWORD_WHILE)){
+    return whileStatement();
+  }
+  if (match(TokenType::KEYWORD_FOR)) {
+    return forStatement();
+  }
+  if (match(TokenType::KEYWORD_RETURN)) {
+    return returnStatement();
+  }
+  if (match(TokenType::KEYWORD_PRINT)) {
+    return printStatement();
   }
+  if (match(TokenType::LEFT_BRACE)) {
+    return blockStatement();
+  }
+  return expressionStatement();
+}
 
-  std::unique_ptr<Statement> Parser::expressionStatement() {
-    auto expr = espression();
-    consume(TokenType::SEMICOLON, "Expected ';' after expression.");
+std::unique_ptr<Statement> Parser::expressionStatement() {
+  auto expr = expression();
+  SourceLocation location = expr->getLocation();
+  consume(TokenType::SEMICOLON, "Expected ';' after expression.");
+
+  return std::make_unique<ExpressionStmt>(std::move(expr), location);
+}
 
-    return std::make_unique<class ExpressionStmt>(std::move(expr), previous().location);
+std::unique_ptr<Statement> Parser::blockStatement() {
+  std::vector<std::unique_ptr<Statement>> statements;
+  SourceLocation location = previous().location;
+
+  while(!check(TokenType::RIGHT_BRACE) && !isAtEnd()){
+    statements.push_back(declaration());
   }
 
-  std::unique_ptr<Statement> Parser::blockStatement() {
-    std::vector<std::unique_ptr<Statement>> statements;
-    SourceLocation location = previous().location;
+  consume(TokenType::RIGHT_BRACE, "Expected '}' after block.");
+  return std::make_unique<BlockStmt>(std::move(statements), location);
+}
 
-    while(!check(TokenType::RIGHT_BRACE) && !isAtEnd()){
-      statements.push_back(declaration());
-    }
+std::unique_ptr<Statement> Parser::ifStatement() {
+  SourceLocation location = previous().location;
+  consume(TokenType::LEFT_PAREN, "Expected '(' after 'if'.");
+  auto condition = expression();
+  consume(TokenType::RIGHT_PAREN, "Expected ')' after condition.");
+
+  auto thenBranch = statement();
+  std::unique_ptr<Statement> elseBranch = nullptr;
+
+  if(match(TokenType::KEYWORD_ELSE)){
+    elseBranch = statement();
+  }
+
+  return std::make_unique<IfStmt>(
+    std::move(condition),
+    std::move(thenBranch),
+    std::move(elseBranch),
+    location
+  );
+}
+
+std::unique_ptr<Statement> Parser::whileStatement() {
+  SourceLocation location = previous().location;
+  consume(TokenType::LEFT_PAREN, "Expected '(' after 'while'.");
+  auto condition = expression();
+  consume(TokenType::RIGHT_PAREN, "Expected ')' after condition.");
+
+  auto body = statement();
+
+  return std::make_unique<WhileStmt>(std::move(condition), std::move(body), location);
+}
+
+std::unique_ptr<Statement> Parser::forStatement() {
+  consume(TokenType::LEFT_PAREN, "Expected '(' after 'for'.");
+  Token variable = consume(TokenType::IDENTIFIER, "Expected loop variable name.");
+  consume(TokenType::COLON, "Expected ':' after loop variable.");
+
+  //Range bounds stay as plain expressions so no range object is built
+  auto start = expression();
+  consume(TokenType::DOT_DOT, "Expected '..' in range.");
+  auto end = expression();
+  consume(TokenType::RIGHT_PAREN, "Expected ')' after range.");
+
+  auto body = statement();
+
+  return std::make_unique<ForRangeStmt>(
+    variable,
+    std::move(start),
+    std::move(end),
+    std::move(body)
+  );
+}
 
-    consume(TokenType::RIGHT_BRACE, "Expected '}' after block.");
-    return std::make_unique<BlockStmt>(std::move(statements), location);
+std::unique_ptr<Statement> Parser::returnStatement() {
+  SourceLocation location = previous().location;
+
+  std::unique_ptr<Expression> value = nullptr;
+  if (!check(TokenType::SEMICOLON)) {
+    value = expression();
   }
 
-  std::unique_ptr<Statement> Parser::ifStatement() {
-      consume(TokenType::LEFT_PAREN, "Expected '(' after 'if'.");
-    auto condition = expression();
-    consume(TokenType::RIGHT_PAREN, "Expected ')' afer condition.")
+  consume(TokenType::SEMICOLON, "Expected ';' after return value.");
+  return std::make_unique<ReturnStmt>(std::move(value), location);
+}
+
+std::unique_ptr<Statement> Parser::printStatement() {
+  SourceLocation location = previous().location;
+  auto value = expression();
+  consume(TokenType::SEMICOLON, "Expected ';' after value.");
+  return std::make_unique<PrintStmt>(std::move(value), location);
+}
+
+//Expressions, from the lowest precedence to the highest
+std::unique_ptr<Expression> Parser::expression() {
+  return assignment();
+}
+
+std::unique_ptr<Expression> Parser::assignment() {
+  auto expr = orExpression();
 
-      auto thenBranch = statement();
-    std::unique_ptr<Statement> elseBranch = nullptr;
+  if (match(TokenType::EQUAL)) {
+    Token equals = previous();
+    auto value = assignment();
 
-    if(match(TokenType::ELSE)){
-      eslseBranch = statement();
+    if (expr->getType() == NodeType::IDENTIFIER) {
+      Token name = Token(TokenType::IDENTIFIER, static_cast<const IdentifierExpr*>(expr.get())->getName(), expr->getLocation());
+      return std::make_unique<AssignExpr>(name, std::move(value));
     }
 
-    return std::make_unique<class IfStmt>(
-      std::move(condition),
-      std::move(thenBranch),
-      std::move(elseBranch),
-      previous().location
-    );
+    throw error(equals, "Invalid assignment target.");
+  }
+
+  return expr;
+}
+
+std::unique_ptr<Expression> Parser::orExpression() {
+  auto expr = andExpression();
+
+  while (match(TokenType::OR_OR)) {
+    Token op = previous();
+    auto right = andExpression();
+    expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
+  }
+
+  return expr;
+}
+
+std::unique_ptr<Expression> Parser::andExpression() {
+  auto expr = equality();
+
+  while (match(TokenType::AND_AND)) {
+    Token op = previous();
+    auto right = equality();
+    expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
   }
 
+  return expr;
+}
+
+std::unique_ptr<Expression> Parser::equality() {
+  auto expr = comparison();
+
+  while (match({TokenType::BANG_EQUAL, TokenType::EQUAL_EQUAL})) {
+    Token op = previous();
+    auto right = comparison();
+    expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
+  }
+
+  return expr;
+}
+
+std::unique_ptr<Expression> Parser::comparison() {
+  auto expr = term();
+
+  while (match({TokenType::GREATER, TokenType::GREATER_EQUAL, TokenType::LESS, TokenType::LESS_EQUAL})) {
+    Token op = previous();
+    auto right = term();
+    expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
+  }
+
+  return expr;
+}
+
+std::unique_ptr<Expression> Parser::term() {
+  auto expr = factor();
+
+  while (match({TokenType::MINUS, TokenType::PLUS})) {
+    Token op = previous();
+    auto right = factor();
+    expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
+  }
+
+  return expr;
+}
 
+std::unique_ptr<Expression> Parser::factor() {
+  auto expr = unary();
+
+  while (match({TokenType::SLASH, TokenType::STAR, TokenType::PERCENT})) {
+    Token op = previous();
+    auto right = unary();
+    expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
+  }
+
+  return expr;
+}
+
+std::unique_ptr<Expression> Parser::unary() {
+  if (match({TokenType::BANG, TokenType::MINUS})) {
+    Token op = previous();
+    auto operand = unary();
+    return std::make_unique<UnaryExpr>(op, std::move(operand));
+  }
+
+  return call();
+}
+
+std::unique_ptr<Expression> Parser::call() {
+  auto expr = primary();
+
+  while (match(TokenType::LEFT_PAREN)) {
+    expr = finishCall(std::move(expr));
+  }
+
+  return expr;
+}
+
+std::unique_ptr<Expression> Parser::finishCall(std::unique_ptr<Expression> callee) {
+  Token paren = previous();
+  std::vector<std::unique_ptr<Expression>> arguments;
+
+  if (!check(TokenType::RIGHT_PAREN)) {
+    do {
+      arguments.push_back(expression());
+    } while (match(TokenType::COMMA));
+  }
+
+  consume(TokenType::RIGHT_PAREN, "Expected ')' after arguments.");
+  return std::make_unique<CallExpr>(std::move(callee), paren, std::move(arguments));
+}
+
+std::unique_ptr<Expression> Parser::primary() {
+  if (match({TokenType::KEYWORD_TRUE, TokenType::KEYWORD_FALSE, TokenType::KEYWORD_NULL,
+             TokenType::INTERGER_LITERAL, TokenType::FLOAT_LITERAL,
+             TokenType::STRING, TokenType::CHAR_LITERAL})) {
+    return std::make_unique<LiteralExpr>(previous());
+  }
+
+  if (match(TokenType::IDENTIFIER)) {
+    return std::make_unique<IdentifierExpr>(previous());
+  }
+
+  //Grouping only changes precedence, so no node is kept for it
+  if (match(TokenType::LEFT_PAREN)) {
+    auto expr = expression();
+    consume(TokenType::RIGHT_PAREN, "Expected ')' after expression.");
+    return expr;
+  }
 
+  if (check(TokenType::TOKEN_ERROR)) throw error(peek(), peek().lexeme);
+  throw error(peek(), "Expected expression.");
 }
 
 }
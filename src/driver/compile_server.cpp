@@ -0,0 +1,445 @@
+#include "pebas/driver/compile_server.h"
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <poll.h>
+#include <set>
+#include <sstream>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "pebas/parser/parser.h"
+#include "pebas/runtime/snapshot.h"
+
+namespace pebas {
+
+//Requests are a single line; anything longer is not a path we can open
+static constexpr size_t MAX_REQUEST = PATH_MAX + 64;
+
+//The server answers one client at a time, so a client that stalls is dropped
+static constexpr int CLIENT_TIMEOUT_MS = 5000;
+
+static constexpr uint32_t WATCH_EVENTS =
+  IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+
+static std::string directoryOf(const std::string& path) {
+  size_t slash = path.rfind('/');
+  if (slash == std::string::npos) return ".";
+  if (slash == 0) return "/";
+  return path.substr(0, slash);
+}
+
+static std::string canonicalPath(const std::string& path) {
+  char resolved[PATH_MAX];
+  if (realpath(path.c_str(), resolved)) return resolved;
+  return path;
+}
+
+static bool readSource(const std::string& path, std::string& source) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  source = contents.str();
+  return true;
+}
+
+//MSG_NOSIGNAL: a peer that hung up must not kill the process with SIGPIPE
+static bool writeAll(int fd, const std::string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t count = send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    written += static_cast<size_t>(count);
+  }
+  return true;
+}
+
+//Requests read files with the server's rights, so only its own user may send them
+static bool isSameUser(int fd) {
+  struct ucred peer;
+  socklen_t length = sizeof(peer);
+  return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &length) == 0 && peer.uid == geteuid();
+}
+
+const CachedModule* ModuleCache::load(const std::string& path, std::string& error) {
+  auto it = modules.find(path);
+  if (it != modules.end() && it->second->watched && !it->second->stale) {
+    return it->second.get();
+  }
+
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0) {
+    error = "Could not read '" + path + "'.";
+    return nullptr;
+  }
+  int64_t mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+  uint64_t size = static_cast<uint64_t>(info.st_size);
+
+  if (it != modules.end() && it->second->mtime == mtime && it->second->size == size) {
+    it->second->stale = false;
+    return it->second.get();
+  }
+
+  std::string source;
+  if (!readSource(path, source)) {
+    error = "Could not read '" + path + "'.";
+    return nullptr;
+  }
+
+  if (it == modules.end()) {
+    auto module = std::make_unique<CachedModule>();
+    module->path = path;
+    it = modules.emplace(path, std::move(module)).first;
+  }
+
+  CachedModule& module = *it->second;
+  module.mtime = mtime;
+  module.size = size;
+  module.stale = false;
+
+  //touched but not edited: keep the parsed program
+  uint64_t hash = hashSource(source);
+  if (module.program && module.hash == hash) return &module;
+
+  module.hash = hash;
+  parse(module, source);
+  return &module;
+}
+
+static std::string errorText(const SourceLocation& location, const std::string& message) {
+  return location.to_string() + ": " + message;
+}
+
+//Forces every function body, nested ones too, so their syntax errors are reported
+static void parseBodies(const Statement* statement, std::vector<std::string>& errors) {
+  if (!statement) return;
+
+  switch (statement->getType()) {
+    case NodeType::FUNCTION: {
+      auto function = static_cast<const FunctionDecl*>(statement);
+      parseBodies(function->getBody(), errors);
+      if (!function->getBodyError().empty()) errors.push_back(function->getBodyError());
+      break;
+    }
+    case NodeType::BLOCK:
+      for (const auto& inner : static_cast<const BlockStmt*>(statement)->getStatements()) {
+        parseBodies(inner.get(), errors);
+      }
+      break;
+    case NodeType::IF:
+      parseBodies(static_cast<const IfStmt*>(statement)->getThenBranch(), errors);
+      parseBodies(static_cast<const IfStmt*>(statement)->getElseBranch(), errors);
+      break;
+    case NodeType::WHILE:
+      parseBodies(static_cast<const WhileStmt*>(statement)->getBody(), errors);
+      break;
+    case NodeType::FOR_RANGE:
+      parseBodies(static_cast<const ForRangeStmt*>(statement)->getBody(), errors);
+      break;
+    default:
+      break;
+  }
+}
+
+void ModuleCache::parse(CachedModule& module, const std::string& source) {
+  Lexer lexer(source, module.path);
+  auto tokens = std::make_shared<const std::vector<Token>>(lexer.tokenizer());
+
+  Parser parser(tokens);
+  module.program = parser.parse();
+  module.tokens = tokens;
+  module.imports.clear();
+  module.errors.clear();
+
+  for (const ParseError& error : parser.getErrors()) {
+    module.errors.push_back(errorText(error.getLocation(), error.what()));
+  }
+
+  for (const auto& statement : module.program->getStatements()) {
+    if (statement->getType() == NodeType::IMPORT) {
+      std::string target = static_cast<const ImportDecl*>(statement.get())->getPath();
+      std::string resolved = !target.empty() && target[0] == '/' ? target : directoryOf(module.path) + "/" + target;
+      module.imports.push_back(canonicalPath(resolved));
+    }
+    parseBodies(statement.get(), module.errors);
+  }
+
+  parseCount++;
+}
+
+void ModuleCache::invalidate(const std::string& path) {
+  auto it = modules.find(path);
+  if (it != modules.end()) it->second->stale = true;
+}
+
+void ModuleCache::invalidateAll() {
+  for (auto& entry : modules) {
+    entry.second->stale = true;
+    entry.second->watched = false;
+  }
+}
+
+void ModuleCache::markWatched(const std::string& path) {
+  auto it = modules.find(path);
+  if (it != modules.end()) it->second->watched = true;
+}
+
+CompileServer::~CompileServer() {
+  if (inotifyFd >= 0) close(inotifyFd);
+  if (listenFd >= 0) {
+    close(listenFd);
+    unlink(socketPath.c_str());
+  }
+}
+
+bool CompileServer::start(std::string& error) {
+  struct sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    error = "Socket path is too long.";
+    return false;
+  }
+  std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+  listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listenFd < 0) {
+    error = std::string("Could not create socket: ") + std::strerror(errno);
+    return false;
+  }
+
+  //Only a stale socket is replaced; a live server keeps its socket
+  struct stat existing;
+  if (lstat(socketPath.c_str(), &existing) == 0) {
+    int probe = S_ISSOCK(existing.st_mode) ? socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0) : -1;
+    bool stale = probe >= 0 &&
+                 connect(probe, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 &&
+                 errno == ECONNREFUSED;
+    if (probe >= 0) close(probe);
+
+    if (!stale) {
+      error = S_ISSOCK(existing.st_mode) ? "A server is already listening on '" + socketPath + "'."
+                                         : "'" + socketPath + "' exists and is not a socket.";
+      close(listenFd);
+      listenFd = -1;
+      return false;
+    }
+    unlink(socketPath.c_str());
+  }
+
+  //Created 0600, so other users cannot connect at all
+  mode_t oldMask = umask(0177);
+  bool bound = bind(listenFd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0;
+  umask(oldMask);
+
+  if (!bound || listen(listenFd, 16) != 0) {
+    error = "Could not listen on '" + socketPath + "': " + std::strerror(errno);
+    if (bound) unlink(socketPath.c_str());
+    close(listenFd);
+    listenFd = -1;
+    return false;
+  }
+
+  //Without inotify every request falls back to stat()ing each module
+  inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  running = true;
+  return true;
+}
+
+void CompileServer::run() {
+  while (running) {
+    struct pollfd fds[2] = {{listenFd, POLLIN, 0}, {inotifyFd, POLLIN, 0}};
+    int count = poll(fds, inotifyFd >= 0 ? 2 : 1, -1);
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+
+    //Apply file changes before answering, so no reply uses stale modules
+    if (inotifyFd >= 0 && (fds[1].revents & POLLIN)) handleFileEvents();
+
+    if (fds[0].revents & POLLIN) {
+      int client = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+      if (client >= 0) {
+        if (isSameUser(client)) {
+          if (inotifyFd >= 0) handleFileEvents();
+          handleClient(client);
+        }
+        close(client);
+      }
+    }
+  }
+}
+
+bool CompileServer::watch(const std::string& path) {
+  if (inotifyFd < 0) return false;
+
+  std::string directory = directoryOf(path);
+  if (directoryWatches.count(directory)) return true;
+
+  int wd = inotify_add_watch(inotifyFd, directory.c_str(), WATCH_EVENTS);
+  if (wd < 0) return false;
+
+  directoryWatches[directory] = wd;
+  watchDirectories[wd] = directory;
+  return true;
+}
+
+void CompileServer::handleFileEvents() {
+  alignas(struct inotify_event) char buffer[16 * 1024];
+
+  while (true) {
+    ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+    if (length <= 0) return;
+
+    for (ssize_t offset = 0; offset < length;) {
+      auto event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+      offset += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        cache.invalidateAll();
+        continue;
+      }
+
+      auto directory = watchDirectories.find(event->wd);
+      if (directory == watchDirectories.end()) continue;
+
+      if (event->mask & IN_IGNORED) {
+        //the directory is gone; its modules must be re-stat()ed and re-watched
+        directoryWatches.erase(directory->second);
+        watchDirectories.erase(directory);
+        cache.invalidateAll();
+        continue;
+      }
+
+      if (event->len > 0) cache.invalidate(directory->second + "/" + event->name);
+    }
+  }
+}
+
+void CompileServer::handleClient(int fd) {
+  struct timeval sendTimeout = {CLIENT_TIMEOUT_MS / 1000, 0};
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+
+  //One deadline for the whole request, so a client trickling bytes is dropped too
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CLIENT_TIMEOUT_MS);
+  std::string request;
+  char buffer[4096];
+
+  while (request.size() < MAX_REQUEST && request.find('\n') == std::string::npos) {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now()).count();
+    if (remaining <= 0) break;
+
+    struct pollfd client = {fd, POLLIN, 0};
+    int ready = poll(&client, 1, static_cast<int>(remaining));
+    if (ready < 0 && errno == EINTR) continue;
+    if (ready <= 0) break;
+
+    ssize_t count = read(fd, buffer, sizeof(buffer));
+    if (count < 0 && errno == EINTR) continue;
+    if (count <= 0) break;
+    request.append(buffer, static_cast<size_t>(count));
+  }
+
+  size_t newline = request.find('\n');
+  if (newline == std::string::npos) {
+    writeAll(fd, "error Incomplete request.\n");
+    return;
+  }
+  request.resize(newline);
+
+  writeAll(fd, handleRequest(request));
+}
+
+std::string CompileServer::handleRequest(const std::string& request) {
+  if (request.rfind("check ", 0) == 0) return check(request.substr(6));
+
+  if (request == "stats") {
+    return "ok " + std::to_string(cache.getModuleCount()) + " modules, " +
+           std::to_string(cache.getParseCount()) + " parses\n";
+  }
+
+  if (request == "shutdown") {
+    running = false;
+    return "ok\n";
+  }
+
+  return "error Unknown request.\n";
+}
+
+//Loads a module and everything it imports; unchanged modules cost a map lookup.
+//Syntax errors are kept with the module, so they are reported until fixed.
+std::string CompileServer::check(const std::string& path) {
+  std::vector<std::string> pending = {canonicalPath(path)};
+  std::set<std::string> visited;
+  std::string errors;
+  size_t parsesBefore = cache.getParseCount();
+
+  while (!pending.empty()) {
+    std::string current = pending.back();
+    pending.pop_back();
+    if (!visited.insert(current).second) continue;
+
+    //watch before reading, so a write racing with the read still invalidates
+    bool watched = watch(current);
+
+    std::string error;
+    const CachedModule* module = cache.load(current, error);
+    if (!module) return "error " + error + "\n";
+
+    if (watched) cache.markWatched(current);
+    pending.insert(pending.end(), module->imports.begin(), module->imports.end());
+    for (const std::string& message : module->errors) errors += "error " + message + "\n";
+  }
+
+  if (!errors.empty()) return errors;
+  return "ok " + std::to_string(visited.size()) + " modules, " +
+         std::to_string(cache.getParseCount() - parsesBefore) + " parsed\n";
+}
+
+int runCompileClient(const std::string& socketPath, const std::string& request) {
+  struct sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Socket path is too long.\n";
+    return 1;
+  }
+  std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0 || connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+    std::cerr << "Could not connect to '" << socketPath << "': " << std::strerror(errno) << "\n";
+    if (fd >= 0) close(fd);
+    return 1;
+  }
+
+  writeAll(fd, request + "\n");
+  shutdown(fd, SHUT_WR);
+
+  std::string reply;
+  char buffer[4096];
+  while (true) {
+    ssize_t count = read(fd, buffer, sizeof(buffer));
+    if (count < 0 && errno == EINTR) continue;
+    if (count <= 0) break;
+    reply.append(buffer, static_cast<size_t>(count));
+  }
+  close(fd);
+
+  std::cout << reply;
+  return reply.rfind("ok", 0) == 0 ? 0 : 1;
+}
+
+}
@@ -0,0 +1,147 @@
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "pebas/ast/ast_printer.h"
+#include "pebas/driver/compile_server.h"
+#include "pebas/lexer/lexer.h"
+#include "pebas/parser/parser.h"
+#include "pebas/runtime/snapshot.h"
+
+using namespace pebas;
+
+static void usage() {
+  std::cerr << "Usage: pebas [--dump=tokens|ast] [--snapshot=<image>] <file>\n"
+            << "       pebas --serve=<socket>\n"
+            << "       pebas --connect=<socket> <file>\n";
+}
+
+static bool readFile(const std::string& path, std::string& source) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  source = contents.str();
+  return true;
+}
+
+int main(int argc, char** argv) {
+  std::string dump;
+  std::string snapshot;
+  std::string serve;
+  std::string connect;
+  std::string path;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg.rfind("--dump=", 0) == 0) {
+      dump = arg.substr(7);
+      if (dump != "tokens" && dump != "ast") {
+        std::cerr << "Unknown dump kind '" << dump << "'.\n";
+        usage();
+        return 1;
+      }
+    } else if (arg.rfind("--snapshot=", 0) == 0) {
+      snapshot = arg.substr(11);
+    } else if (arg.rfind("--serve=", 0) == 0) {
+      serve = arg.substr(8);
+    } else if (arg.rfind("--connect=", 0) == 0) {
+      connect = arg.substr(10);
+    } else if (path.empty()) {
+      path = arg;
+    } else {
+      usage();
+      return 1;
+    }
+  }
+
+  if (!serve.empty()) {
+    CompileServer server(serve);
+    std::string error;
+    if (!server.start(error)) {
+      std::cerr << error << "\n";
+      return 1;
+    }
+    server.run();
+    return 0;
+  }
+
+  if (path.empty()) {
+    usage();
+    return 1;
+  }
+
+  //The server resolves paths from its own working directory, so send an absolute one
+  if (!connect.empty()) {
+    char resolved[PATH_MAX];
+    if (!realpath(path.c_str(), resolved)) {
+      std::cerr << "Could not read '" << path << "'.\n";
+      return 1;
+    }
+    return runCompileClient(connect, std::string("check ") + resolved);
+  }
+
+  std::string source;
+  if (!readFile(path, source)) {
+    std::cerr << "Could not read '" << path << "'.\n";
+    return 1;
+  }
+
+  //Reuse the snapshot's tokens while the source is unchanged, otherwise refresh it.
+  //Modules are keyed by canonical path, so `a.pb` and `./a.pb` share one entry;
+  //the tokens carry that name either way, so locations match on a hit or a miss.
+  std::string name = path;
+  std::vector<Token> tokens;
+  std::unique_ptr<SnapshotImage> image;
+  int module = -1;
+
+  if (!snapshot.empty()) {
+    char resolved[PATH_MAX];
+    if (realpath(path.c_str(), resolved)) name = resolved;
+
+    image = SnapshotImage::open(snapshot);
+    if (image) module = image->findModule(name, source);
+  }
+
+  if (module >= 0) {
+    tokens = image->getTokens(module);
+  } else {
+    Lexer lexer(source, name);
+    tokens = lexer.tokenizer();
+
+    if (!snapshot.empty()) {
+      //Keep the image's other modules, so a shared image is only ever extended
+      SnapshotWriter writer;
+      if (image) writer.addImage(*image, name);
+      writer.addModule(name, source, tokens);
+      if (!writer.write(snapshot)) {
+        std::cerr << "Could not write snapshot '" << snapshot << "'.\n";
+      }
+    }
+  }
+
+  if (dump == "tokens") {
+    for (const Token& token : tokens) {
+      std::cout << token.to_string() << '\n';
+    }
+    return 0;
+  }
+
+  //Lazy mode: function bodies are only parsed when something needs them
+  Parser parser(std::make_shared<const std::vector<Token>>(std::move(tokens)));
+  std::unique_ptr<Program> program = parser.parse();
+
+  if (dump == "ast") {
+    AstPrinter(std::cout).print(*program);
+  }
+
+  for (const ParseError& error : parser.getErrors()) {
+    std::cerr << error.getLocation().to_string() << ": " << error.what() << "\n";
+  }
+
+  return parser.getErrors().empty() ? 0 : 1;
+}
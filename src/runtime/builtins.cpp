@@ -0,0 +1,372 @@
+#include "pebas/runtime/builtins.h"
+#include <cstring>
+#include <unordered_map>
+
+namespace pebas {
+
+namespace {
+
+//Generic vectors, lowered by GCC/Clang to SSE/AVX/NEON
+#ifdef __AVX2__
+constexpr size_t VECTOR_BYTES = 32;
+#else
+constexpr size_t VECTOR_BYTES = 16;
+#endif
+
+typedef int64_t IntVec __attribute__((vector_size(VECTOR_BYTES)));
+typedef double FloatVec __attribute__((vector_size(VECTOR_BYTES)));
+
+template <typename V, typename T>
+constexpr size_t lanes() { return sizeof(V) / sizeof(T); }
+
+//memcpy keeps loads/stores legal on unaligned data; it compiles to a single move
+template <typename V, typename T>
+V load(const T* p) {
+  V v;
+  std::memcpy(&v, p, sizeof(V));
+  return v;
+}
+
+template <typename V, typename T>
+void store(T* p, V v) {
+  std::memcpy(p, &v, sizeof(V));
+}
+
+struct Add {
+  template <typename X> X operator()(X a, X b) const { return a + b; }
+};
+
+struct Mul {
+  template <typename X> X operator()(X a, X b) const { return a * b; }
+};
+
+struct Min {
+  template <typename X> X operator()(X a, X b) const { return a < b ? a : b; }
+};
+
+struct Max {
+  template <typename X> X operator()(X a, X b) const { return a > b ? a : b; }
+};
+
+//Two independent accumulators hide the latency of the vector op
+template <typename V, typename T, typename Op>
+T reduce(const T* data, size_t count, Op op) {
+  constexpr size_t n = lanes<V, T>();
+  size_t i = 0;
+  T result;
+
+  if (count >= 2 * n) {
+    V acc0 = load<V>(data);
+    V acc1 = load<V>(data + n);
+    for (i = 2 * n; i + 2 * n <= count; i += 2 * n) {
+      acc0 = op(acc0, load<V>(data + i));
+      acc1 = op(acc1, load<V>(data + i + n));
+    }
+    acc0 = op(acc0, acc1);
+
+    result = acc0[0];
+    for (size_t k = 1; k < n; k++) result = op(result, acc0[k]);
+  } else {
+    result = data[0];
+    i = 1;
+  }
+
+  for (; i < count; i++) result = op(result, data[i]);
+  return result;
+}
+
+template <typename V, typename T>
+T sum(const T* data, size_t count) {
+  if (count == 0) return 0;
+  return reduce<V>(data, count, Add());
+}
+
+template <typename V, typename T>
+T dot(const T* a, const T* b, size_t count) {
+  constexpr size_t n = lanes<V, T>();
+  V acc0 = {};
+  V acc1 = {};
+  size_t i = 0;
+
+  for (; i + 2 * n <= count; i += 2 * n) {
+    acc0 += load<V>(a + i) * load<V>(b + i);
+    acc1 += load<V>(a + i + n) * load<V>(b + i + n);
+  }
+  acc0 += acc1;
+
+  T result = 0;
+  for (size_t k = 0; k < n; k++) result += acc0[k];
+  for (; i < count; i++) result += a[i] * b[i];
+  return result;
+}
+
+template <typename V, typename T, typename Op>
+void mapConst(const T* src, T* dst, size_t count, T value, Op op) {
+  constexpr size_t n = lanes<V, T>();
+  V splat = V{} + value;
+  size_t i = 0;
+
+  for (; i + n <= count; i += n) {
+    store(dst + i, op(load<V>(src + i), splat));
+  }
+  for (; i < count; i++) dst[i] = op(src[i], value);
+}
+
+//Argument helpers for the CALL entry points
+void expectArity(const char* name, const std::vector<Value>& args, size_t min, size_t max) {
+  if (args.size() < min || args.size() > max) {
+    throw BuiltinError(std::string("Wrong number of arguments to '") + name + "'.");
+  }
+}
+
+int64_t intArg(const char* name, const Value& value) {
+  if (auto v = std::get_if<int64_t>(&value)) return *v;
+  throw BuiltinError(std::string("Expected int argument to '") + name + "'.");
+}
+
+double floatArg(const char* name, const Value& value) {
+  if (auto v = std::get_if<double>(&value)) return *v;
+  if (auto v = std::get_if<int64_t>(&value)) return static_cast<double>(*v);
+  throw BuiltinError(std::string("Expected float argument to '") + name + "'.");
+}
+
+const RopeString& stringArg(const char* name, const Value& value) {
+  if (auto v = std::get_if<RopeString>(&value)) return *v;
+  throw BuiltinError(std::string("Expected string argument to '") + name + "'.");
+}
+
+const IntArray* intArray(const Value& value) {
+  auto v = std::get_if<std::shared_ptr<IntArray>>(&value);
+  return v ? v->get() : nullptr;
+}
+
+const FloatArray* floatArray(const Value& value) {
+  auto v = std::get_if<std::shared_ptr<FloatArray>>(&value);
+  return v ? v->get() : nullptr;
+}
+
+[[noreturn]] void expectedArray(const char* name) {
+  throw BuiltinError(std::string("Expected array argument to '") + name + "'.");
+}
+
+Value builtinIntArray(const std::vector<Value>& args) {
+  expectArity("intArray", args, 1, 2);
+  int64_t size = intArg("intArray", args[0]);
+  if (size < 0) throw BuiltinError("Negative array size.");
+  int64_t fill = args.size() > 1 ? intArg("intArray", args[1]) : 0;
+  return std::make_shared<IntArray>(static_cast<size_t>(size), fill);
+}
+
+Value builtinFloatArray(const std::vector<Value>& args) {
+  expectArity("floatArray", args, 1, 2);
+  int64_t size = intArg("floatArray", args[0]);
+  if (size < 0) throw BuiltinError("Negative array size.");
+  double fill = args.size() > 1 ? floatArg("floatArray", args[1]) : 0.0;
+  return std::make_shared<FloatArray>(static_cast<size_t>(size), fill);
+}
+
+Value builtinLength(const std::vector<Value>& args) {
+  expectArity("length", args, 1, 1);
+  if (auto a = intArray(args[0])) return static_cast<int64_t>(a->size());
+  if (auto a = floatArray(args[0])) return static_cast<int64_t>(a->size());
+  return static_cast<int64_t>(stringArg("length", args[0]).size());
+}
+
+Value builtinSum(const std::vector<Value>& args) {
+  expectArity("sum", args, 1, 1);
+  if (auto a = intArray(args[0])) return sumInt(a->data(), a->size());
+  if (auto a = floatArray(args[0])) return sumFloat(a->data(), a->size());
+  expectedArray("sum");
+}
+
+Value builtinMin(const std::vector<Value>& args) {
+  expectArity("min", args, 1, 1);
+  if (auto a = intArray(args[0])) {
+    if (a->empty()) throw BuiltinError("'min' of an empty array.");
+    return minInt(a->data(), a->size());
+  }
+  if (auto a = floatArray(args[0])) {
+    if (a->empty()) throw BuiltinError("'min' of an empty array.");
+    return minFloat(a->data(), a->size());
+  }
+  expectedArray("min");
+}
+
+Value builtinMax(const std::vector<Value>& args) {
+  expectArity("max", args, 1, 1);
+  if (auto a = intArray(args[0])) {
+    if (a->empty()) throw BuiltinError("'max' of an empty array.");
+    return maxInt(a->data(), a->size());
+  }
+  if (auto a = floatArray(args[0])) {
+    if (a->empty()) throw BuiltinError("'max' of an empty array.");
+    return maxFloat(a->data(), a->size());
+  }
+  expectedArray("max");
+}
+
+Value builtinDot(const std::vector<Value>& args) {
+  expectArity("dot", args, 2, 2);
+  auto ia = intArray(args[0]);
+  auto ib = intArray(args[1]);
+  if (ia && ib) {
+    if (ia->size() != ib->size()) throw BuiltinError("'dot' of arrays with different lengths.");
+    return dotInt(ia->data(), ib->data(), ia->size());
+  }
+  auto fa = floatArray(args[0]);
+  auto fb = floatArray(args[1]);
+  if (fa && fb) {
+    if (fa->size() != fb->size()) throw BuiltinError("'dot' of arrays with different lengths.");
+    return dotFloat(fa->data(), fb->data(), fa->size());
+  }
+  throw BuiltinError("Expected two arrays of the same type to 'dot'.");
+}
+
+Value builtinAdd(const std::vector<Value>& args) {
+  expectArity("add", args, 2, 2);
+  if (auto a = intArray(args[0])) {
+    auto result = std::make_shared<IntArray>(a->size());
+    addConstInt(a->data(), result->data(), a->size(), intArg("add", args[1]));
+    return result;
+  }
+  if (auto a = floatArray(args[0])) {
+    auto result = std::make_shared<FloatArray>(a->size());
+    addConstFloat(a->data(), result->data(), a->size(), floatArg("add", args[1]));
+    return result;
+  }
+  expectedArray("add");
+}
+
+Value builtinMul(const std::vector<Value>& args) {
+  expectArity("mul", args, 2, 2);
+  if (auto a = intArray(args[0])) {
+    auto result = std::make_shared<IntArray>(a->size());
+    mulConstInt(a->data(), result->data(), a->size(), intArg("mul", args[1]));
+    return result;
+  }
+  if (auto a = floatArray(args[0])) {
+    auto result = std::make_shared<FloatArray>(a->size());
+    mulConstFloat(a->data(), result->data(), a->size(), floatArg("mul", args[1]));
+    return result;
+  }
+  expectedArray("mul");
+}
+
+Value builtinFind(const std::vector<Value>& args) {
+  expectArity("find", args, 2, 3);
+  std::string_view haystack = stringArg("find", args[0]).view();
+  std::string_view needle = stringArg("find", args[1]).view();
+  int64_t from = args.size() > 2 ? intArg("find", args[2]) : 0;
+  if (from < 0) throw BuiltinError("Negative start index to 'find'.");
+
+  if (needle.size() == 1) return findByte(haystack, needle[0], static_cast<size_t>(from));
+  return findString(haystack, needle, static_cast<size_t>(from));
+}
+
+Value builtinEquals(const std::vector<Value>& args) {
+  expectArity("equals", args, 2, 2);
+  //Interned literals compare by pointer before any bytes are read
+  return stringArg("equals", args[0]) == stringArg("equals", args[1]);
+}
+
+Value builtinConcat(const std::vector<Value>& args) {
+  std::vector<const RopeString*> parts;
+  parts.reserve(args.size());
+  for (const Value& arg : args) {
+    parts.push_back(&stringArg("concat", arg));
+  }
+  return concat(parts);
+}
+
+}
+
+int64_t sumInt(const int64_t* data, size_t count) { return sum<IntVec>(data, count); }
+double sumFloat(const double* data, size_t count) { return sum<FloatVec>(data, count); }
+int64_t minInt(const int64_t* data, size_t count) { return reduce<IntVec>(data, count, Min()); }
+double minFloat(const double* data, size_t count) { return reduce<FloatVec>(data, count, Min()); }
+int64_t maxInt(const int64_t* data, size_t count) { return reduce<IntVec>(data, count, Max()); }
+double maxFloat(const double* data, size_t count) { return reduce<FloatVec>(data, count, Max()); }
+
+int64_t dotInt(const int64_t* a, const int64_t* b, size_t count) {
+  return dot<IntVec>(a, b, count);
+}
+
+double dotFloat(const double* a, const double* b, size_t count) {
+  return dot<FloatVec>(a, b, count);
+}
+
+void addConstInt(const int64_t* src, int64_t* dst, size_t count, int64_t value) {
+  mapConst<IntVec>(src, dst, count, value, Add());
+}
+
+void addConstFloat(const double* src, double* dst, size_t count, double value) {
+  mapConst<FloatVec>(src, dst, count, value, Add());
+}
+
+void mulConstInt(const int64_t* src, int64_t* dst, size_t count, int64_t value) {
+  mapConst<IntVec>(src, dst, count, value, Mul());
+}
+
+void mulConstFloat(const double* src, double* dst, size_t count, double value) {
+  mapConst<FloatVec>(src, dst, count, value, Mul());
+}
+
+//memchr/memmem are already SIMD in the C library
+int64_t findByte(std::string_view haystack, char byte, size_t from) {
+  if (from >= haystack.size()) return -1;
+
+  const void* hit = std::memchr(haystack.data() + from, byte, haystack.size() - from);
+  if (!hit) return -1;
+  return static_cast<const char*>(hit) - haystack.data();
+}
+
+int64_t findString(std::string_view haystack, std::string_view needle, size_t from) {
+  if (from > haystack.size()) return -1;
+  if (needle.empty()) return static_cast<int64_t>(from);
+
+#ifdef __GLIBC__
+  const void* hit = memmem(haystack.data() + from, haystack.size() - from, needle.data(), needle.size());
+  if (!hit) return -1;
+  return static_cast<const char*>(hit) - haystack.data();
+#else
+  size_t pos = haystack.find(needle, from);
+  return pos == std::string_view::npos ? -1 : static_cast<int64_t>(pos);
+#endif
+}
+
+bool stringEquals(std::string_view a, std::string_view b) {
+  return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+//Builds a rope; the bytes are copied once, when the result is first read
+RopeString concat(const std::vector<const RopeString*>& parts) {
+  RopeString result;
+  for (const RopeString* part : parts) result = result + *part;
+  return result;
+}
+
+NativeFunction findBuiltin(const std::string& name) {
+  static const std::unordered_map<std::string, NativeFunction> builtins = {
+    {"intArray", builtinIntArray},
+    {"floatArray", builtinFloatArray},
+    {"length", builtinLength},
+    {"sum", builtinSum},
+    {"min", builtinMin},
+    {"max", builtinMax},
+    {"dot", builtinDot},
+    {"add", builtinAdd},
+    {"mul", builtinMul},
+    {"find", builtinFind},
+    {"equals", builtinEquals},
+    {"concat", builtinConcat}
+  };
+
+  auto it = builtins.find(name);
+
+  if (it != builtins.end()) {
+    return it->second;
+  }
+  return nullptr;
+}
+
+}
@@ -0,0 +1,144 @@
+#include "pebas/runtime/output.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <unistd.h>
+
+namespace pebas {
+
+//Longest shortest-round-trip double, e.g. "-2.2250738585072014e-308"
+static constexpr size_t MAX_NUMBER_CHARS = 32;
+
+//Numbers are formatted in place, so the buffer must hold at least one
+OutputBuffer::OutputBuffer(int fd, size_t capacity)
+    : fd(fd), lineBuffered(isatty(fd) == 1), capacity(std::max(capacity, MAX_NUMBER_CHARS)),
+      buffer(new char[this->capacity]) {}
+
+OutputBuffer::~OutputBuffer() {
+  flush();
+}
+
+OutputBuffer& OutputBuffer::standardOutput() {
+  thread_local OutputBuffer output(STDOUT_FILENO);
+  return output;
+}
+
+//Returns room for `size` bytes. When they do not fit, only the complete
+//lines are written, so output from different threads is split between lines.
+char* OutputBuffer::reserve(size_t size) {
+  if (used + size <= capacity) return buffer.get() + used;
+
+  size_t lastNewline = std::string_view(buffer.get(), used).rfind('\n');
+  if (lastNewline != std::string_view::npos) {
+    size_t complete = lastNewline + 1;
+    writeAll(buffer.get(), complete);
+    std::memmove(buffer.get(), buffer.get() + complete, used - complete);
+    used -= complete;
+  }
+
+  //a single line longer than the buffer has to be split
+  if (used + size > capacity) flush();
+  return buffer.get() + used;
+}
+
+void OutputBuffer::write(std::string_view text) {
+  if (text.size() > capacity) {
+    flush();
+    writeAll(text.data(), text.size());
+    return;
+  }
+
+  std::memcpy(reserve(text.size()), text.data(), text.size());
+  used += text.size();
+}
+
+void OutputBuffer::write(const RopeString& text) {
+  write(text.view());
+}
+
+void OutputBuffer::write(int64_t value) {
+  char* out = reserve(MAX_NUMBER_CHARS);
+  used = std::to_chars(out, out + MAX_NUMBER_CHARS, value).ptr - buffer.get();
+}
+
+//Shortest round-trip form, but a float always keeps a fraction or exponent
+//so 1.0 does not print like the int 1 ("inf" and "nan" are left alone)
+void OutputBuffer::write(double value) {
+  char* out = reserve(MAX_NUMBER_CHARS);
+  char* end = std::to_chars(out, out + MAX_NUMBER_CHARS, value).ptr;
+  if (std::find_if(out, end, [](char c) { return c == '.' || c == 'e' || c == 'n'; }) == end) {
+    *end++ = '.';
+    *end++ = '0';
+  }
+  used = end - buffer.get();
+}
+
+void OutputBuffer::write(bool value) {
+  write(std::string_view(value ? "true" : "false"));
+}
+
+void OutputBuffer::write(const Value& value) {
+  if (std::holds_alternative<std::monostate>(value)) {
+    write(std::string_view("null"));
+  } else if (auto v = std::get_if<int64_t>(&value)) {
+    write(*v);
+  } else if (auto v = std::get_if<double>(&value)) {
+    write(*v);
+  } else if (auto v = std::get_if<bool>(&value)) {
+    write(*v);
+  } else if (auto v = std::get_if<RopeString>(&value)) {
+    write(*v);
+  } else if (auto v = std::get_if<std::shared_ptr<IntArray>>(&value)) {
+    write(std::string_view("["));
+    for (size_t i = 0; i < (*v)->size(); i++) {
+      if (i > 0) write(std::string_view(", "));
+      write((**v)[i]);
+    }
+    write(std::string_view("]"));
+  } else if (auto v = std::get_if<std::shared_ptr<FloatArray>>(&value)) {
+    write(std::string_view("["));
+    for (size_t i = 0; i < (*v)->size(); i++) {
+      if (i > 0) write(std::string_view(", "));
+      write((**v)[i]);
+    }
+    write(std::string_view("]"));
+  }
+}
+
+void OutputBuffer::endLine() {
+  *reserve(1) = '\n';
+  used++;
+  if (lineBuffered) flush();
+}
+
+void OutputBuffer::flush() {
+  if (used == 0) return;
+
+  writeAll(buffer.get(), used);
+  used = 0;
+}
+
+void OutputBuffer::writeAll(const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return; //nowhere left to report the error (closed pipe, full disk ...)
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+}
+
+void printValue(const Value& value) {
+  OutputBuffer& output = OutputBuffer::standardOutput();
+  output.write(value);
+  output.endLine();
+}
+
+void flushOutput() {
+  OutputBuffer::standardOutput().flush();
+}
+
+}
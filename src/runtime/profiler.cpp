@@ -0,0 +1,360 @@
+#include "pebas/runtime/profiler.h"
+#include <algorithm>
+#include <csignal>
+#include <map>
+#include <ctime>
+#include <pthread.h>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+//glibc does not always expose the kernel's name for this field
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace pebas {
+
+void CallStack::push(const FunctionDecl* function, int line) {
+  int current = depth.load(std::memory_order_relaxed);
+  if (current < MAX_DEPTH) {
+    functions[current] = function;
+    lines[current].store(line, std::memory_order_relaxed);
+  }
+  std::atomic_signal_fence(std::memory_order_release);
+  depth.store(current + 1, std::memory_order_relaxed);
+}
+
+void CallStack::pop() {
+  depth.store(depth.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+}
+
+void CallStack::setLine(int line) {
+  int current = depth.load(std::memory_order_relaxed);
+  if (current > 0 && current <= MAX_DEPTH) {
+    lines[current - 1].store(line, std::memory_order_relaxed);
+  }
+}
+
+ProfileFrame CallStack::getFrame(int index) const {
+  return ProfileFrame{functions[index], lines[index].load(std::memory_order_relaxed)};
+}
+
+std::atomic<Profiler*> Profiler::active{nullptr};
+
+//Power of two at least twice `count`, so probe chains stay short
+static size_t tableSize(size_t count) {
+  size_t size = 2;
+  while (size < count * 2) size *= 2;
+  return size;
+}
+
+Profiler::Profiler(const CallStack& stack, int frequency, size_t maxStacks, size_t maxFrames)
+    : stack(stack), frequency(frequency), maxStacks(maxStacks), maxFrames(maxFrames),
+      stacks(new Stack[maxStacks]), frames(new ProfileFrame[maxFrames]),
+      slotMask(tableSize(maxStacks) - 1), slots(new size_t[slotMask + 1]()) {}
+
+Profiler::~Profiler() {
+  stop();
+}
+
+bool Profiler::start() {
+  Profiler* expected = nullptr;
+  if (running || !active.compare_exchange_strong(expected, this)) return false;
+
+  struct sigaction action = {};
+  action.sa_handler = handleSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, &previousAction) != 0) {
+    active.store(nullptr);
+    return false;
+  }
+
+  //A thread CPU-time timer aimed at this thread: SIGPROF from setitimer()
+  //goes to the whole process and could land on a lexer worker instead
+  struct sigevent event = {};
+  event.sigev_notify = SIGEV_THREAD_ID;
+  event.sigev_signo = SIGPROF;
+  event.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+  if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer) != 0) {
+    sigaction(SIGPROF, &previousAction, nullptr);
+    active.store(nullptr);
+    return false;
+  }
+
+  long interval = 1000000000 / std::max(frequency, 1);
+  struct itimerspec spec = {};
+  spec.it_interval.tv_sec = interval / 1000000000;
+  spec.it_interval.tv_nsec = interval % 1000000000;
+  spec.it_value = spec.it_interval;
+  if (timer_settime(timer, 0, &spec, nullptr) != 0) {
+    timer_delete(timer);
+    sigaction(SIGPROF, &previousAction, nullptr);
+    active.store(nullptr);
+    return false;
+  }
+
+  running = true;
+  return true;
+}
+
+void Profiler::stop() {
+  if (!running) return;
+
+  //Block SIGPROF while the timer goes away and drop any signal it left
+  //pending, so the restored handler never sees one of ours
+  sigset_t profSignal;
+  sigset_t oldMask;
+  sigemptyset(&profSignal);
+  sigaddset(&profSignal, SIGPROF);
+  pthread_sigmask(SIG_BLOCK, &profSignal, &oldMask);
+
+  timer_delete(timer);
+  struct timespec noWait = {};
+  while (sigtimedwait(&profSignal, nullptr, &noWait) == SIGPROF) {}
+
+  sigaction(SIGPROF, &previousAction, nullptr);
+  pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+
+  active.store(nullptr);
+  running = false;
+}
+
+void Profiler::handleSignal(int) {
+  Profiler* profiler = active.load(std::memory_order_relaxed);
+  if (profiler) profiler->takeSample();
+}
+
+bool Profiler::sameStack(const Stack& entry, int depth, int kept) const {
+  if (entry.depth != kept) return false;
+
+  for (int i = 0; i < kept; i++) {
+    ProfileFrame frame = stack.getFrame(depth - 1 - i);
+    const ProfileFrame& stored = frames[entry.firstFrame + i];
+    if (stored.function != frame.function || stored.line != frame.line) return false;
+  }
+  return true;
+}
+
+//Runs inside the signal handler: no allocation, no locks
+void Profiler::takeSample() {
+  int depth = std::min(stack.getDepth(), static_cast<int>(CallStack::MAX_DEPTH));
+  std::atomic_signal_fence(std::memory_order_acquire);
+  if (depth <= 0) return;
+
+  int kept = std::min(depth, MAX_SAMPLE_DEPTH);
+
+  //FNV-1a over the frames, leaf first
+  uint64_t hash = 14695981039346656037ull;
+  for (int i = 0; i < kept; i++) {
+    ProfileFrame frame = stack.getFrame(depth - 1 - i);
+    hash = (hash ^ reinterpret_cast<uintptr_t>(frame.function)) * 1099511628211ull;
+    hash = (hash ^ static_cast<uint32_t>(frame.line)) * 1099511628211ull;
+  }
+
+  size_t slot = static_cast<size_t>(hash) & slotMask;
+  while (slots[slot] != 0) {
+    Stack& entry = stacks[slots[slot] - 1];
+    if (entry.hash == hash && sameStack(entry, depth, kept)) {
+      entry.count.fetch_add(1, std::memory_order_relaxed);
+      sampleCount.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    slot = (slot + 1) & slotMask;
+  }
+
+  size_t count = stackCount.load(std::memory_order_relaxed);
+  if (count >= maxStacks || frameCount + kept > maxFrames) {
+    droppedCount.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  Stack& entry = stacks[count];
+  entry.firstFrame = frameCount;
+  entry.depth = kept;
+  entry.hash = hash;
+  entry.count.store(1, std::memory_order_relaxed);
+  for (int i = 0; i < kept; i++) {
+    frames[frameCount + i] = stack.getFrame(depth - 1 - i);
+  }
+  frameCount += kept;
+  slots[slot] = count + 1;
+  stackCount.store(count + 1, std::memory_order_release);
+  sampleCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+static std::string frameName(const ProfileFrame& frame) {
+  std::string name = frame.function ? frame.function->getName() : "<main>";
+  return name + ":" + std::to_string(frame.line);
+}
+
+void Profiler::writeCollapsed(std::ostream& out) const {
+  std::map<std::string, size_t> collapsed;
+  size_t count = getStackCount();
+
+  for (size_t i = 0; i < count; i++) {
+    const Stack& entry = stacks[i];
+    std::string key;
+    for (int j = entry.depth - 1; j >= 0; j--) {
+      if (!key.empty()) key += ';';
+      key += frameName(frames[entry.firstFrame + j]);
+    }
+    collapsed[key] += entry.count.load(std::memory_order_relaxed);
+  }
+
+  for (const auto& entry : collapsed) {
+    out << entry.first << ' ' << entry.second << '\n';
+  }
+}
+
+//Minimal protobuf encoder for the handful of profile.proto messages we emit
+namespace {
+
+class ProtoWriter {
+public:
+  const std::string& data() const { return buffer; }
+
+  void varint(uint64_t value) {
+    while (value >= 0x80) {
+      buffer.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+  }
+
+  void intField(int field, uint64_t value) {
+    varint(static_cast<uint64_t>(field) << 3);
+    varint(value);
+  }
+
+  void bytesField(int field, const std::string& bytes) {
+    varint((static_cast<uint64_t>(field) << 3) | 2);
+    varint(bytes.size());
+    buffer.append(bytes);
+  }
+
+  void raw(const std::string& bytes) {
+    buffer.append(bytes);
+  }
+
+  void packedField(int field, const std::vector<uint64_t>& values) {
+    ProtoWriter packed;
+    for (uint64_t value : values) packed.varint(value);
+    bytesField(field, packed.data());
+  }
+
+private:
+  std::string buffer;
+};
+
+class StringTable {
+public:
+  StringTable() { index(""); }
+
+  uint64_t index(const std::string& text) {
+    auto it = indices.find(text);
+    if (it != indices.end()) return it->second;
+
+    indices.emplace(text, strings.size());
+    strings.push_back(text);
+    return strings.size() - 1;
+  }
+
+  const std::vector<std::string>& getStrings() const { return strings; }
+
+private:
+  std::unordered_map<std::string, uint64_t> indices;
+  std::vector<std::string> strings;
+};
+
+std::string valueType(StringTable& strings, const std::string& type, const std::string& unit) {
+  ProtoWriter message;
+  message.intField(1, strings.index(type));
+  message.intField(2, strings.index(unit));
+  return message.data();
+}
+
+}
+
+void Profiler::writePprof(std::ostream& out) const {
+  StringTable strings;
+  std::map<const FunctionDecl*, uint64_t> functionIds;
+  std::map<std::pair<uint64_t, int>, uint64_t> locationIds;
+  std::map<std::vector<uint64_t>, uint64_t> samples;
+  ProtoWriter functions;
+  ProtoWriter locations;
+
+  size_t count = getStackCount();
+  for (size_t i = 0; i < count; i++) {
+    const Stack& entry = stacks[i];
+    std::vector<uint64_t> stackIds;
+
+    for (int j = 0; j < entry.depth; j++) {
+      const ProfileFrame& frame = frames[entry.firstFrame + j];
+
+      auto function = functionIds.find(frame.function);
+      if (function == functionIds.end()) {
+        uint64_t id = functionIds.size() + 1;
+        function = functionIds.emplace(frame.function, id).first;
+
+        ProtoWriter message;
+        message.intField(1, id);
+        message.intField(2, strings.index(frame.function ? frame.function->getName() : "<main>"));
+        if (frame.function) {
+          SourceLocation location = frame.function->getLocation();
+          message.intField(4, strings.index(location.filename));
+          message.intField(5, static_cast<uint64_t>(location.line));
+        }
+        functions.bytesField(5, message.data());
+      }
+
+      auto key = std::make_pair(function->second, frame.line);
+      auto location = locationIds.find(key);
+      if (location == locationIds.end()) {
+        uint64_t id = locationIds.size() + 1;
+        location = locationIds.emplace(key, id).first;
+
+        ProtoWriter line;
+        line.intField(1, function->second);
+        line.intField(2, static_cast<uint64_t>(frame.line));
+        ProtoWriter message;
+        message.intField(1, id);
+        message.bytesField(4, line.data());
+        locations.bytesField(4, message.data());
+      }
+
+      stackIds.push_back(location->second);
+    }
+    samples[stackIds] += entry.count.load(std::memory_order_relaxed);
+  }
+
+  uint64_t period = 1000000000ull / static_cast<uint64_t>(std::max(frequency, 1));
+  std::string samplesType = valueType(strings, "samples", "count");
+  std::string cpuType = valueType(strings, "cpu", "nanoseconds");
+
+  ProtoWriter profile;
+  profile.bytesField(1, samplesType);
+  profile.bytesField(1, cpuType);
+
+  for (const auto& entry : samples) {
+    ProtoWriter sample;
+    sample.packedField(1, entry.first);
+    sample.packedField(2, {entry.second, entry.second * period});
+    profile.bytesField(2, sample.data());
+  }
+
+  profile.raw(locations.data());
+  profile.raw(functions.data());
+  for (const std::string& text : strings.getStrings()) {
+    profile.bytesField(6, text);
+  }
+  profile.bytesField(11, cpuType);
+  profile.intField(12, period);
+
+  out << profile.data();
+}
+
+}
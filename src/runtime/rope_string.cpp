@@ -0,0 +1,208 @@
+#include "pebas/runtime/rope_string.h"
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace pebas {
+
+struct RopeString::Node {
+  std::atomic<uint32_t> refs{1};
+  size_t length;
+  bool isFlat;
+  std::string flat;
+  RopeString left;
+  RopeString right;
+
+  Node(std::string text) : length(text.size()), isFlat(true), flat(std::move(text)) {}
+
+  Node(const RopeString& left, const RopeString& right)
+      : length(left.size() + right.size()), isFlat(false), left(left), right(right) {}
+};
+
+RopeString::RopeString() : tag(0) {
+  small[0] = '\0';
+}
+
+RopeString::RopeString(std::string_view text) {
+  if (text.size() <= INLINE_CAPACITY) {
+    std::memcpy(small, text.data(), text.size());
+    small[text.size()] = '\0';
+    tag = static_cast<uint8_t>(text.size());
+  } else {
+    Node* node = new Node(std::string(text));
+    std::memcpy(small, &node, sizeof(node));
+    tag = HEAP_TAG;
+  }
+}
+
+RopeString::RopeString(Node* node) : tag(HEAP_TAG) {
+  std::memcpy(small, &node, sizeof(node));
+}
+
+RopeString::RopeString(const RopeString& other) : tag(other.tag) {
+  std::memcpy(small, other.small, sizeof(small));
+  if (tag == HEAP_TAG) heapNode()->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+RopeString::RopeString(RopeString&& other) noexcept : RopeString() {
+  swap(other);
+}
+
+RopeString& RopeString::operator=(RopeString other) noexcept {
+  swap(other);
+  return *this;
+}
+
+RopeString::~RopeString() {
+  if (tag == HEAP_TAG) release(heapNode());
+}
+
+RopeString::Node* RopeString::heapNode() const {
+  Node* node;
+  std::memcpy(&node, small, sizeof(node));
+  return node;
+}
+
+void RopeString::swap(RopeString& other) noexcept {
+  char temp[sizeof(small)];
+  std::memcpy(temp, small, sizeof(small));
+  std::memcpy(small, other.small, sizeof(small));
+  std::memcpy(other.small, temp, sizeof(small));
+  std::swap(tag, other.tag);
+}
+
+//Frees a node and any children it was the last owner of.
+//Uses a worklist because a rope built in a loop is as deep as the loop.
+void RopeString::release(Node* node) {
+  if (node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+  if (node->isFlat) {
+    delete node;
+    return;
+  }
+
+  std::vector<Node*> dead;
+  dead.push_back(node);
+
+  while (!dead.empty()) {
+    Node* current = dead.back();
+    dead.pop_back();
+
+    for (RopeString* child : {&current->left, &current->right}) {
+      if (child->tag != HEAP_TAG) continue;
+
+      Node* childNode = child->heapNode();
+      child->tag = 0;
+      child->small[0] = '\0';
+      if (childNode->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        dead.push_back(childNode);
+      }
+    }
+    delete current;
+  }
+}
+
+void RopeString::flatten(Node* node) {
+  if (node->isFlat) return;
+
+  std::string out;
+  out.reserve(node->length);
+
+  std::vector<const RopeString*> pending;
+  pending.push_back(&node->right);
+  pending.push_back(&node->left);
+
+  while (!pending.empty()) {
+    const RopeString* piece = pending.back();
+    pending.pop_back();
+
+    if (piece->tag != HEAP_TAG) {
+      out.append(piece->small, piece->tag);
+    } else if (piece->heapNode()->isFlat) {
+      out.append(piece->heapNode()->flat);
+    } else {
+      pending.push_back(&piece->heapNode()->right);
+      pending.push_back(&piece->heapNode()->left);
+    }
+  }
+
+  node->flat = std::move(out);
+  node->isFlat = true;
+  node->left = RopeString();
+  node->right = RopeString();
+}
+
+size_t RopeString::size() const {
+  return tag == HEAP_TAG ? heapNode()->length : tag;
+}
+
+bool RopeString::isRope() const {
+  return tag == HEAP_TAG && !heapNode()->isFlat;
+}
+
+std::string_view RopeString::view() const {
+  if (tag != HEAP_TAG) return std::string_view(small, tag);
+
+  Node* node = heapNode();
+  flatten(node);
+  return node->flat;
+}
+
+char RopeString::at(size_t index) const {
+  std::string_view text = view();
+  if (index >= text.size()) throw std::out_of_range("String index out of range.");
+  return text[index];
+}
+
+RopeString operator+(const RopeString& left, const RopeString& right) {
+  if (left.empty()) return right;
+  if (right.empty()) return left;
+
+  size_t total = left.size() + right.size();
+
+  if (total <= RopeString::FLAT_LIMIT) {
+    std::string_view a = left.view();
+    std::string_view b = right.view();
+
+    if (total <= RopeString::INLINE_CAPACITY) {
+      RopeString result;
+      std::memcpy(result.small, a.data(), a.size());
+      std::memcpy(result.small + a.size(), b.data(), b.size());
+      result.small[total] = '\0';
+      result.tag = static_cast<uint8_t>(total);
+      return result;
+    }
+
+    std::string flat;
+    flat.reserve(total);
+    flat.append(a);
+    flat.append(b);
+    return RopeString(new RopeString::Node(std::move(flat)));
+  }
+
+  return RopeString(new RopeString::Node(left, right));
+}
+
+bool operator==(const RopeString& left, const RopeString& right) {
+  if (left.tag == RopeString::HEAP_TAG && right.tag == RopeString::HEAP_TAG &&
+      left.heapNode() == right.heapNode()) {
+    return true;
+  }
+  if (left.size() != right.size()) return false;
+  return left.view() == right.view();
+}
+
+RopeString StringInterner::intern(std::string_view text) {
+  if (text.size() <= RopeString::INLINE_CAPACITY) return RopeString(text);
+
+  auto it = strings.find(text);
+  if (it != strings.end()) return it->second;
+
+  RopeString value(text);
+  std::string_view key = value.view();
+  strings.emplace(key, value);
+  return value;
+}
+
+}
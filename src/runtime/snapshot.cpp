@@ -0,0 +1,289 @@
+#include "pebas/runtime/snapshot.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pebas {
+
+//Bump VERSION whenever a record layout changes. Token streams are also
+//tied to the lexer that produced them: its revision and the TokenType
+//numbering are stored in the header and must match too.
+static constexpr char MAGIC[8] = {'P', 'E', 'B', 'A', 'S', 'I', 'M', 'G'};
+static constexpr uint32_t VERSION = 3;
+static constexpr uint32_t TOKEN_TYPE_COUNT = static_cast<uint32_t>(TokenType::TOKEN_EOF) + 1;
+
+namespace {
+
+struct ImageHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t endianCheck;
+  uint32_t lexerRevision;
+  uint32_t tokenTypeCount;
+  uint64_t imageSize;
+  uint64_t moduleCount;
+  uint64_t modulesOffset;
+  uint64_t tokenCount;
+  uint64_t tokensOffset;
+  uint64_t stringsOffset;
+  uint64_t stringsSize;
+};
+
+struct ModuleRecord {
+  uint64_t nameOffset;
+  uint64_t nameLength;
+  uint64_t sourceHash;
+  uint64_t sourceSize;
+  uint64_t firstToken;
+  uint64_t tokenCount;
+};
+
+struct TokenRecord {
+  uint32_t type;
+  int32_t line;
+  int32_t column;
+  int32_t intValue;
+  uint64_t lexemeOffset;
+  uint64_t lexemeLength;
+  uint64_t stringOffset;
+  uint64_t stringLength;
+  double floatValue;
+  uint64_t boolValue;
+};
+
+//Appends `text` to the string blob and returns its offset within the blob
+uint64_t addText(std::string& blob, std::string_view text) {
+  uint64_t offset = blob.size();
+  blob.append(text);
+  return offset;
+}
+
+template <typename Record>
+void appendRecord(std::string& image, const Record& record) {
+  image.append(reinterpret_cast<const char*>(&record), sizeof(Record));
+}
+
+template <typename Record>
+Record readRecord(const char* base, uint64_t offset) {
+  Record record;
+  std::memcpy(&record, base + offset, sizeof(Record));
+  return record;
+}
+
+}
+
+//FNV-1a; only used to notice that a cached module's source changed
+uint64_t hashSource(std::string_view source) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : source) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+void SnapshotWriter::addModule(const std::string& name, const std::string& source, const std::vector<Token>& tokens) {
+  modules.push_back(Module{name, hashSource(source), source.size(), tokens});
+}
+
+void SnapshotWriter::addImage(const SnapshotImage& image, const std::string& replaced) {
+  ImageHeader header = readRecord<ImageHeader>(image.base, 0);
+
+  for (uint64_t i = 0; i < header.moduleCount; i++) {
+    ModuleRecord module = readRecord<ModuleRecord>(image.base, header.modulesOffset + i * sizeof(ModuleRecord));
+    std::string name(image.text(module.nameOffset, module.nameLength));
+    if (name == replaced) continue;
+
+    modules.push_back(Module{name, module.sourceHash, module.sourceSize, image.getTokens(static_cast<int>(i))});
+  }
+}
+
+bool SnapshotWriter::write(const std::string& path) const {
+  uint64_t tokenCount = 0;
+  for (const Module& module : modules) tokenCount += module.tokens.size();
+
+  ImageHeader header = {};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.endianCheck = 0x01020304;
+  header.lexerRevision = LEXER_REVISION;
+  header.tokenTypeCount = TOKEN_TYPE_COUNT;
+  header.moduleCount = modules.size();
+  header.modulesOffset = sizeof(ImageHeader);
+  header.tokenCount = tokenCount;
+  header.tokensOffset = header.modulesOffset + modules.size() * sizeof(ModuleRecord);
+  header.stringsOffset = header.tokensOffset + tokenCount * sizeof(TokenRecord);
+
+  std::string records;
+  std::string blob;
+  uint64_t firstToken = 0;
+
+  for (const Module& module : modules) {
+    ModuleRecord record = {};
+    record.nameOffset = addText(blob, module.name);
+    record.nameLength = module.name.size();
+    record.sourceHash = module.sourceHash;
+    record.sourceSize = module.sourceSize;
+    record.firstToken = firstToken;
+    record.tokenCount = module.tokens.size();
+    appendRecord(records, record);
+    firstToken += module.tokens.size();
+  }
+
+  for (const Module& module : modules) {
+    for (const Token& token : module.tokens) {
+      TokenRecord record = {};
+      record.type = static_cast<uint32_t>(token.type);
+      record.line = token.location.line;
+      record.column = token.location.column;
+      record.intValue = token.intValue;
+      record.lexemeOffset = addText(blob, token.lexeme);
+      record.lexemeLength = token.lexeme.size();
+      record.stringOffset = addText(blob, token.stringValue);
+      record.stringLength = token.stringValue.size();
+      record.floatValue = token.floatValue;
+      record.boolValue = token.boolValue;
+      appendRecord(records, record);
+    }
+  }
+
+  header.stringsSize = blob.size();
+  header.imageSize = header.stringsOffset + blob.size();
+
+  //A unique name per writer: concurrent runs refreshing the same image must
+  //not truncate each other's file before the rename
+  std::string temporary = path + ".XXXXXX";
+  int fd = mkstemp(&temporary[0]);
+  if (fd < 0) return false;
+
+  //mkstemp creates the file 0600; a refreshed image keeps the mode it had
+  struct stat existing;
+  if (stat(path.c_str(), &existing) == 0 && fchmod(fd, existing.st_mode & 07777) != 0) {
+    close(fd);
+    std::remove(temporary.c_str());
+    return false;
+  }
+
+  FILE* file = fdopen(fd, "wb");
+  if (!file) {
+    close(fd);
+    std::remove(temporary.c_str());
+    return false;
+  }
+
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+            std::fwrite(records.data(), 1, records.size(), file) == records.size() &&
+            std::fwrite(blob.data(), 1, blob.size(), file) == blob.size();
+  ok = std::fclose(file) == 0 && ok;
+
+  if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<SnapshotImage> SnapshotImage::open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ImageHeader)) {
+    close(fd);
+    return nullptr;
+  }
+
+  size_t size = static_cast<size_t>(info.st_size);
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) return nullptr;
+
+  std::unique_ptr<SnapshotImage> image(new SnapshotImage(static_cast<const char*>(mapping), size));
+  if (!image->validate()) return nullptr;
+  return image;
+}
+
+SnapshotImage::~SnapshotImage() {
+  munmap(const_cast<char*>(base), size);
+}
+
+//Checks every table lies inside the file so later reads need no bounds checks
+bool SnapshotImage::validate() const {
+  ImageHeader header = readRecord<ImageHeader>(base, 0);
+
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+  if (header.version != VERSION || header.endianCheck != 0x01020304) return false;
+  if (header.lexerRevision != LEXER_REVISION || header.tokenTypeCount != TOKEN_TYPE_COUNT) return false;
+  if (header.imageSize != size) return false;
+
+  auto fits = [this](uint64_t offset, uint64_t count, uint64_t recordSize) {
+    return offset <= size && count <= (size - offset) / recordSize;
+  };
+  if (!fits(header.modulesOffset, header.moduleCount, sizeof(ModuleRecord))) return false;
+  if (!fits(header.tokensOffset, header.tokenCount, sizeof(TokenRecord))) return false;
+  if (!fits(header.stringsOffset, header.stringsSize, 1)) return false;
+
+  for (uint64_t i = 0; i < header.moduleCount; i++) {
+    ModuleRecord module = readRecord<ModuleRecord>(base, header.modulesOffset + i * sizeof(ModuleRecord));
+    if (module.firstToken > header.tokenCount ||
+        module.tokenCount > header.tokenCount - module.firstToken) {
+      return false;
+    }
+  }
+
+  //getTokens() casts the stored type straight to TokenType
+  for (uint64_t i = 0; i < header.tokenCount; i++) {
+    TokenRecord token = readRecord<TokenRecord>(base, header.tokensOffset + i * sizeof(TokenRecord));
+    if (token.type >= header.tokenTypeCount) return false;
+  }
+  return true;
+}
+
+std::string_view SnapshotImage::text(uint64_t offset, uint64_t length) const {
+  ImageHeader header = readRecord<ImageHeader>(base, 0);
+  if (offset > header.stringsSize || length > header.stringsSize - offset) return std::string_view();
+  return std::string_view(base + header.stringsOffset + offset, length);
+}
+
+int SnapshotImage::findModule(const std::string& name, const std::string& source) const {
+  ImageHeader header = readRecord<ImageHeader>(base, 0);
+
+  for (uint64_t i = 0; i < header.moduleCount; i++) {
+    ModuleRecord module = readRecord<ModuleRecord>(base, header.modulesOffset + i * sizeof(ModuleRecord));
+    if (text(module.nameOffset, module.nameLength) != name) continue;
+    if (module.sourceSize == source.size() && module.sourceHash == hashSource(source)) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+std::vector<Token> SnapshotImage::getTokens(int index) const {
+  ImageHeader header = readRecord<ImageHeader>(base, 0);
+  ModuleRecord module = readRecord<ModuleRecord>(base, header.modulesOffset + index * sizeof(ModuleRecord));
+  std::string name(text(module.nameOffset, module.nameLength));
+
+  std::vector<Token> tokens;
+  tokens.reserve(module.tokenCount);
+
+  for (uint64_t i = 0; i < module.tokenCount; i++) {
+    uint64_t offset = header.tokensOffset + (module.firstToken + i) * sizeof(TokenRecord);
+    TokenRecord record = readRecord<TokenRecord>(base, offset);
+
+    Token token(static_cast<TokenType>(record.type),
+                std::string(text(record.lexemeOffset, record.lexemeLength)),
+                SourceLocation(name, record.line, record.column));
+    token.intValue = record.intValue;
+    token.floatValue = record.floatValue;
+    token.boolValue = record.boolValue != 0;
+    token.stringValue = std::string(text(record.stringOffset, record.stringLength));
+    tokens.push_back(std::move(token));
+  }
+  return tokens;
+}
+
+}
@@ -0,0 +1,104 @@
+//Differential test: tokenizerParallel() must return exactly the tokens of
+//tokenizer() for any input, including strings, block comments and char
+//literals that straddle chunk boundaries.
+//
+//Build and run from the repository root:
+//  g++ -std=c++17 -pthread -Iinclude -o parallel_lexer_test
+//      tests/lexer/parallel_lexer_test.cpp src/compiler/lexer/lexer.cpp
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+#include "pebas/lexer/lexer.h"
+
+using namespace pebas;
+
+static constexpr int ITERATIONS = 3000;
+
+static bool sameToken(const Token& a, const Token& b) {
+  return a.type == b.type && a.lexeme == b.lexeme &&
+         a.location.filename == b.location.filename &&
+         a.location.line == b.location.line && a.location.column == b.location.column &&
+         a.intValue == b.intValue && a.floatValue == b.floatValue &&
+         a.boolValue == b.boolValue && a.stringValue == b.stringValue;
+}
+
+//Text with no digits, so fragments never join into an out-of-range number
+static std::string filler(std::mt19937& random, size_t maxLength) {
+  static const char alphabet[] = "abc XYZ_;(){}\n\t.";
+  std::uniform_int_distribution<size_t> length(0, maxLength);
+  std::uniform_int_distribution<size_t> pick(0, sizeof(alphabet) - 2);
+
+  std::string text;
+  for (size_t i = length(random); i > 0; i--) text += alphabet[pick(random)];
+  return text;
+}
+
+static std::string fragment(std::mt19937& random) {
+  static const char* const operators[] = {
+    "(", ")", "{", "}", "[", "]", ";", ":", ",", ".", "..", "+", "-", "->", "*", "/",
+    "=", "==", "!", "!=", "<", "<=", ">", ">=", "&&", "||", "&", "|", "@"
+  };
+  static const char* const words[] = {
+    "var", "function", "for", "if", "else", "return", "import", "print", "true", "null", "x", "count_2"
+  };
+
+  switch (std::uniform_int_distribution<int>(0, 13)(random)) {
+    case 0: return "\n";
+    case 1: return " ";
+    case 2: return words[std::uniform_int_distribution<size_t>(0, std::size(words) - 1)(random)];
+    case 3: return operators[std::uniform_int_distribution<size_t>(0, std::size(operators) - 1)(random)];
+    case 4: return std::to_string(std::uniform_int_distribution<int>(0, 99999999)(random)) + " ";
+    case 5: return std::to_string(std::uniform_int_distribution<int>(0, 9999)(random)) + ".5 ";
+    case 6: return "\"" + filler(random, 40) + "\"";
+    case 7: return "\"" + filler(random, 10) + "\\\"" + filler(random, 10) + "\"";
+    case 8: return "#*" + filler(random, 60) + "*#";
+    case 9: return "#" + filler(random, 20) + "\n";
+    case 10: return "'a'";
+    case 11: return "'\\n'";
+    case 12: return "\n'";
+    default: return "\"";
+  }
+}
+
+int main() {
+  std::mt19937 random(20240611);
+  int failures = 0;
+
+  for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+    std::string source;
+    size_t fragments = std::uniform_int_distribution<size_t>(0, 600)(random);
+    for (size_t i = 0; i < fragments; i++) source += fragment(random);
+
+    unsigned threads = std::uniform_int_distribution<unsigned>(2, 8)(random);
+    size_t minChunk = std::uniform_int_distribution<size_t>(1, 64)(random);
+
+    Lexer sequential(source, "test.pb");
+    Lexer parallel(source, "test.pb");
+    std::vector<Token> expected = sequential.tokenizer();
+    std::vector<Token> actual = parallel.tokenizerParallel(threads, minChunk);
+
+    size_t mismatch = 0;
+    while (mismatch < expected.size() && mismatch < actual.size() &&
+           sameToken(expected[mismatch], actual[mismatch])) {
+      mismatch++;
+    }
+
+    if (mismatch != expected.size() || expected.size() != actual.size()) {
+      failures++;
+      std::cerr << "iteration " << iteration << ": " << expected.size() << " tokens expected, "
+                << actual.size() << " lexed in parallel (" << threads << " threads, chunks of "
+                << minChunk << "+ bytes)\n";
+      if (mismatch < expected.size()) std::cerr << "  expected " << expected[mismatch].to_string() << "\n";
+      if (mismatch < actual.size()) std::cerr << "  got      " << actual[mismatch].to_string() << "\n";
+    }
+  }
+
+  if (failures > 0) {
+    std::cerr << failures << " of " << ITERATIONS << " inputs differ\n";
+    return 1;
+  }
+  std::cout << ITERATIONS << " inputs lexed identically\n";
+  return 0;
+}
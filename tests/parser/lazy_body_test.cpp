@@ -0,0 +1,124 @@
+//Lazy function bodies: the parser only brace-matches them, getBody()
+//builds them on first use, and a syntax error inside a body is reported
+//through getBodyError() instead of failing the whole parse.
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "pebas/parser/parser.h"
+
+using namespace pebas;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& message) {
+  if (!condition) {
+    failures++;
+    std::cerr << "FAILED: " << message << "\n";
+  }
+}
+
+static std::unique_ptr<Program> parseLazy(const std::string& source, std::vector<ParseError>& errors) {
+  Lexer lexer(source, "test.pb");
+  Parser parser(std::make_shared<const std::vector<Token>>(lexer.tokenizer()));
+  std::unique_ptr<Program> program = parser.parse();
+  errors = parser.getErrors();
+  return program;
+}
+
+static const FunctionDecl* function(const Program& program, size_t index) {
+  const auto& statements = program.getStatements();
+  if (index >= statements.size() || statements[index]->getType() != NodeType::FUNCTION) return nullptr;
+  return static_cast<const FunctionDecl*>(statements[index].get());
+}
+
+static void testUntouchedBodiesStayUnparsed() {
+  std::vector<ParseError> errors;
+  auto program = parseLazy(
+    "function a(x: int) -> int { return x + 1; }\n"
+    "function b() { var y = (1 + 2) * 3; while (y > 0) { y = y - 1; } }\n",
+    errors);
+
+  check(errors.empty(), "valid bodies parse without errors");
+  const FunctionDecl* a = function(*program, 0);
+  const FunctionDecl* b = function(*program, 1);
+  check(a && b, "both functions are declared");
+  if (!a || !b) return;
+
+  check(!a->isBodyParsed() && !b->isBodyParsed(), "bodies are not parsed by parse()");
+
+  const BlockStmt* body = a->getBody();
+  check(body && body->getStatements().size() == 1, "getBody() builds the body on first use");
+  check(a->isBodyParsed() && a->getBodyError().empty(), "a forced body is marked parsed");
+  check(a->getBody() == body, "a second getBody() returns the same body");
+  check(!b->isBodyParsed(), "forcing one body leaves the others unparsed");
+}
+
+static void testBrokenBodyIsReported() {
+  std::vector<ParseError> errors;
+  auto program = parseLazy(
+    "function broken() {\n"
+    "  var x = ;\n"
+    "}\n"
+    "var after = 1;\n",
+    errors);
+
+  //Balanced braces are all parse() checks, so the error waits for getBody()
+  check(errors.empty(), "a balanced broken body does not fail parse()");
+  check(program->getStatements().size() == 2, "the statement after a broken body is parsed");
+
+  const FunctionDecl* broken = function(*program, 0);
+  check(broken != nullptr, "the broken function is declared");
+  if (!broken) return;
+
+  check(broken->getBodyError().empty(), "no body error before getBody()");
+  check(broken->getBody() == nullptr, "a broken body is null");
+  check(broken->isBodyParsed(), "a broken body is not parsed again");
+  check(broken->getBodyError() == "test.pb:2:11: Expected expression.",
+        "getBodyError() gives the location and message, got '" + broken->getBodyError() + "'");
+}
+
+static void testUnbalancedBodyFailsParse() {
+  std::vector<ParseError> errors;
+  parseLazy("function f() { (1 + 2 }\nvar after = 1;\n", errors);
+
+  check(errors.size() == 1, "an unbalanced body is a parse() error");
+  if (!errors.empty()) {
+    check(std::string(errors[0].what()) == "Unbalanced '}' in function body.",
+          "unbalanced bracket message, got '" + std::string(errors[0].what()) + "'");
+    check(errors[0].getLocation().line == 1 && errors[0].getLocation().column == 23,
+          "unbalanced bracket location");
+  }
+}
+
+static void testLexerErrorInBodyFailsParse() {
+  std::vector<ParseError> errors;
+  parseLazy("function f() { var s = \"unterminated; }\n", errors);
+  check(!errors.empty(), "a lexer error inside a skipped body is a parse() error");
+}
+
+static void testEagerParserBuildsBodies() {
+  std::string source = "function f() { return 1; }";
+  Lexer lexer(source, "test.pb");
+  std::vector<Token> tokens = lexer.tokenizer();
+  Parser parser(tokens);
+  auto program = parser.parse();
+
+  const FunctionDecl* f = function(*program, 0);
+  check(f && f->isBodyParsed(), "the eager parser builds bodies in parse()");
+}
+
+int main() {
+  testUntouchedBodiesStayUnparsed();
+  testBrokenBodyIsReported();
+  testUnbalancedBodyFailsParse();
+  testLexerErrorInBodyFailsParse();
+  testEagerParserBuildsBodies();
+
+  if (failures > 0) {
+    std::cerr << failures << " checks failed\n";
+    return 1;
+  }
+  std::cout << "lazy body checks passed\n";
+  return 0;
+}
@@ -0,0 +1,197 @@
+//Vector kernels against plain scalar loops. Sizes 0..69 cover inputs
+//shorter than two vectors (count < 2 * lanes), the two-accumulator loop
+//with every length of scalar tail, and the lane reduction; the extreme
+//value is moved through every position so each accumulator and lane wins
+//once. Float inputs are small integers, so every summation order is exact.
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "pebas/runtime/builtins.h"
+
+using namespace pebas;
+
+static constexpr size_t MAX_COUNT = 69;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& message) {
+  if (!condition) {
+    failures++;
+    std::cerr << "FAILED: " << message << "\n";
+  }
+}
+
+//Deterministic values in [-50, 50], so no product or sum overflows
+static std::vector<int64_t> intValues(size_t count, int64_t seed) {
+  std::vector<int64_t> values(count);
+  for (size_t i = 0; i < count; i++) {
+    values[i] = static_cast<int64_t>((i * 37 + static_cast<size_t>(seed) * 11) % 101) - 50;
+  }
+  return values;
+}
+
+static std::vector<double> floatValues(size_t count, int64_t seed) {
+  std::vector<double> values;
+  for (int64_t value : intValues(count, seed)) values.push_back(static_cast<double>(value));
+  return values;
+}
+
+template <typename T>
+static T scalarSum(const std::vector<T>& values) {
+  T result = 0;
+  for (T value : values) result += value;
+  return result;
+}
+
+template <typename T>
+static T scalarDot(const std::vector<T>& a, const std::vector<T>& b) {
+  T result = 0;
+  for (size_t i = 0; i < a.size(); i++) result += a[i] * b[i];
+  return result;
+}
+
+template <typename T>
+static T scalarMin(const std::vector<T>& values) {
+  T result = values[0];
+  for (T value : values) result = value < result ? value : result;
+  return result;
+}
+
+template <typename T>
+static T scalarMax(const std::vector<T>& values) {
+  T result = values[0];
+  for (T value : values) result = value > result ? value : result;
+  return result;
+}
+
+static std::string at(const char* kernel, size_t count) {
+  return std::string(kernel) + " of " + std::to_string(count) + " elements";
+}
+
+static void testReductions() {
+  for (size_t count = 0; count <= MAX_COUNT; count++) {
+    auto ints = intValues(count, 1);
+    auto otherInts = intValues(count, 2);
+    auto floats = floatValues(count, 1);
+    auto otherFloats = floatValues(count, 2);
+
+    check(sumInt(ints.data(), count) == scalarSum(ints), at("sumInt", count));
+    check(sumFloat(floats.data(), count) == scalarSum(floats), at("sumFloat", count));
+    check(dotInt(ints.data(), otherInts.data(), count) == scalarDot(ints, otherInts), at("dotInt", count));
+    check(dotFloat(floats.data(), otherFloats.data(), count) == scalarDot(floats, otherFloats),
+          at("dotFloat", count));
+
+    if (count == 0) continue;
+    check(minInt(ints.data(), count) == scalarMin(ints), at("minInt", count));
+    check(maxInt(ints.data(), count) == scalarMax(ints), at("maxInt", count));
+    check(minFloat(floats.data(), count) == scalarMin(floats), at("minFloat", count));
+    check(maxFloat(floats.data(), count) == scalarMax(floats), at("maxFloat", count));
+  }
+}
+
+//The extreme sits in either accumulator, any lane, or the scalar tail
+static void testExtremeAtEveryPosition() {
+  for (size_t count = 1; count <= MAX_COUNT; count++) {
+    for (size_t position = 0; position < count; position++) {
+      std::vector<int64_t> ints(count, 7);
+      std::vector<double> floats(count, 7.0);
+
+      ints[position] = -1000;
+      floats[position] = -1000.0;
+      check(minInt(ints.data(), count) == -1000, at("minInt", count) + " at " + std::to_string(position));
+      check(minFloat(floats.data(), count) == -1000.0, at("minFloat", count) + " at " + std::to_string(position));
+
+      ints[position] = 1000;
+      floats[position] = 1000.0;
+      check(maxInt(ints.data(), count) == 1000, at("maxInt", count) + " at " + std::to_string(position));
+      check(maxFloat(floats.data(), count) == 1000.0, at("maxFloat", count) + " at " + std::to_string(position));
+
+      //a single non-zero term must reach the result from any lane
+      std::vector<int64_t> ones(count, 1);
+      std::vector<int64_t> single(count, 0);
+      single[position] = 5;
+      check(dotInt(single.data(), ones.data(), count) == 5, at("dotInt", count) + " at " + std::to_string(position));
+      check(sumInt(single.data(), count) == 5, at("sumInt", count) + " at " + std::to_string(position));
+    }
+  }
+}
+
+//Vector loads are unaligned memcpys, so an odd start must work too
+static void testUnalignedInput() {
+  auto ints = intValues(MAX_COUNT + 1, 3);
+  auto floats = floatValues(MAX_COUNT + 1, 3);
+  std::vector<int64_t> tailInts(ints.begin() + 1, ints.end());
+  std::vector<double> tailFloats(floats.begin() + 1, floats.end());
+
+  check(sumInt(ints.data() + 1, MAX_COUNT) == scalarSum(tailInts), "unaligned sumInt");
+  check(sumFloat(floats.data() + 1, MAX_COUNT) == scalarSum(tailFloats), "unaligned sumFloat");
+  check(minInt(ints.data() + 1, MAX_COUNT) == scalarMin(tailInts), "unaligned minInt");
+  check(maxFloat(floats.data() + 1, MAX_COUNT) == scalarMax(tailFloats), "unaligned maxFloat");
+}
+
+static void testMapConst() {
+  for (size_t count = 0; count <= MAX_COUNT; count++) {
+    auto ints = intValues(count, 4);
+    auto floats = floatValues(count, 4);
+    std::vector<int64_t> intResult(count + 1, 99);
+    std::vector<double> floatResult(count + 1, 99.0);
+
+    addConstInt(ints.data(), intResult.data(), count, 3);
+    for (size_t i = 0; i < count; i++) check(intResult[i] == ints[i] + 3, at("addConstInt", count));
+    check(intResult[count] == 99, at("addConstInt", count) + " writes past the end");
+
+    mulConstInt(ints.data(), intResult.data(), count, -2);
+    for (size_t i = 0; i < count; i++) check(intResult[i] == ints[i] * -2, at("mulConstInt", count));
+
+    addConstFloat(floats.data(), floatResult.data(), count, 0.5);
+    for (size_t i = 0; i < count; i++) check(floatResult[i] == floats[i] + 0.5, at("addConstFloat", count));
+    check(floatResult[count] == 99.0, at("addConstFloat", count) + " writes past the end");
+
+    mulConstFloat(floats.data(), floatResult.data(), count, 4.0);
+    for (size_t i = 0; i < count; i++) check(floatResult[i] == floats[i] * 4.0, at("mulConstFloat", count));
+
+    //src and dst may alias
+    std::vector<int64_t> inPlace = ints;
+    addConstInt(inPlace.data(), inPlace.data(), count, 1);
+    for (size_t i = 0; i < count; i++) check(inPlace[i] == ints[i] + 1, at("in-place addConstInt", count));
+  }
+}
+
+static void testCallEntryPoints() {
+  auto array = std::make_shared<IntArray>(intValues(MAX_COUNT, 5));
+  Value sum = findBuiltin("sum")({array});
+  check(std::get<int64_t>(sum) == scalarSum(*array), "sum() builtin");
+
+  bool threw = false;
+  try {
+    findBuiltin("min")({std::make_shared<IntArray>()});
+  } catch (const BuiltinError&) {
+    threw = true;
+  }
+  check(threw, "min() of an empty array throws BuiltinError");
+
+  threw = false;
+  try {
+    findBuiltin("dot")({std::make_shared<FloatArray>(3), std::make_shared<FloatArray>(4)});
+  } catch (const BuiltinError&) {
+    threw = true;
+  }
+  check(threw, "dot() of different lengths throws BuiltinError");
+}
+
+int main() {
+  testReductions();
+  testExtremeAtEveryPosition();
+  testUnalignedInput();
+  testMapConst();
+  testCallEntryPoints();
+
+  if (failures > 0) {
+    std::cerr << failures << " checks failed\n";
+    return 1;
+  }
+  std::cout << "vector kernel checks passed\n";
+  return 0;
+}
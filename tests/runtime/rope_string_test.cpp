@@ -0,0 +1,166 @@
+//RopeString layout and rope behaviour: the inline limit, the flat-copy
+//limit for short concatenations, flattening of left- and right-deep
+//ropes, releasing a rope deeper than the call stack could recurse, and
+//the interner's shared-node fast path for equality.
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "pebas/runtime/rope_string.h"
+
+using namespace pebas;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& message) {
+  if (!condition) {
+    failures++;
+    std::cerr << "FAILED: " << message << "\n";
+  }
+}
+
+static void testInlineLimit() {
+  check(sizeof(RopeString) == 24, "RopeString is 24 bytes");
+  check(RopeString::INLINE_CAPACITY == 22, "inline capacity is 22 bytes");
+
+  RopeString longest(std::string(22, 'a'));
+  RopeString tooLong(std::string(23, 'a'));
+  check(longest.isInline() && longest.size() == 22, "22 bytes are stored inline");
+  check(!tooLong.isInline() && tooLong.size() == 23, "23 bytes go to the heap");
+  check(RopeString().isInline() && RopeString().empty(), "the empty string is inline");
+
+  RopeString joined = RopeString(std::string(11, 'a')) + RopeString(std::string(11, 'b'));
+  check(joined.isInline() && joined.str() == std::string(11, 'a') + std::string(11, 'b'),
+        "a 22-byte concatenation stays inline");
+  RopeString spilled = RopeString(std::string(11, 'a')) + RopeString(std::string(12, 'b'));
+  check(!spilled.isInline() && !spilled.isRope(), "a 23-byte concatenation is a flat heap copy");
+}
+
+static void testFlatLimit() {
+  check(RopeString::FLAT_LIMIT == 128, "flat limit is 128 bytes");
+
+  RopeString left(std::string(64, 'x'));
+  RopeString atLimit = left + RopeString(std::string(64, 'y'));
+  RopeString overLimit = left + RopeString(std::string(65, 'y'));
+
+  check(!atLimit.isRope() && atLimit.size() == 128, "a 128-byte concatenation is copied flat");
+  check(overLimit.isRope() && overLimit.size() == 129, "a 129-byte concatenation is a rope");
+
+  check(overLimit.str() == std::string(64, 'x') + std::string(65, 'y'), "a rope reads back its bytes");
+  check(!overLimit.isRope(), "reading a rope flattens it");
+
+  RopeString empty;
+  check((overLimit + empty).isRope() == overLimit.isRope(), "appending the empty string shares the value");
+}
+
+//Every piece is longer than FLAT_LIMIT, so each `+` makes a rope node
+static std::string piece(int index) {
+  return std::string(130, static_cast<char>('a' + index % 26));
+}
+
+static void testLeftDeepFlatten() {
+  RopeString rope;
+  std::string expected;
+  for (int i = 0; i < 1000; i++) {
+    rope = rope + RopeString(piece(i));
+    expected += piece(i);
+  }
+
+  check(rope.isRope() && rope.size() == expected.size(), "left-deep rope size");
+  check(rope.view() == expected, "left-deep rope flattens in order");
+  check(rope.at(130 * 999) == piece(999)[0], "indexing a flattened left-deep rope");
+}
+
+static void testRightDeepFlatten() {
+  RopeString rope;
+  std::string expected;
+  for (int i = 0; i < 1000; i++) {
+    rope = RopeString(piece(i)) + rope;
+    expected = piece(i) + expected;
+  }
+
+  check(rope.isRope() && rope.size() == expected.size(), "right-deep rope size");
+  check(rope.view() == expected, "right-deep rope flattens in order");
+}
+
+//A node shared by two ropes is flattened through either without changing the other
+static void testSharedSubrope() {
+  RopeString shared = RopeString(piece(0)) + RopeString(piece(1));
+  RopeString twice = shared + shared;
+  RopeString other = RopeString(piece(2)) + shared;
+
+  check(twice.str() == piece(0) + piece(1) + piece(0) + piece(1), "a rope that repeats a subrope");
+  check(shared.isRope(), "flattening a parent leaves the shared child alone");
+  check(other.str() == piece(2) + piece(0) + piece(1), "another parent of the shared child");
+  check(shared.str() == piece(0) + piece(1), "the shared child reads back its bytes");
+}
+
+//Destroying these recursively would need a stack frame per node
+static void testDeepRelease() {
+  constexpr int NODES = 1000000;
+
+  {
+    RopeString left(piece(0));
+    for (int i = 0; i < NODES; i++) left = left + RopeString("z");
+    check(left.isRope() && left.size() == 130 + NODES, "1M-node left-deep rope size");
+  }
+  {
+    RopeString right(piece(0));
+    for (int i = 0; i < NODES; i++) right = RopeString("z") + right;
+    check(right.isRope() && right.size() == 130 + NODES, "1M-node right-deep rope size");
+
+    //flattening is iterative too
+    std::string_view text = right.view();
+    check(text.size() == 130 + NODES && text.front() == 'z' && text.back() == 'a',
+          "1M-node right-deep rope flattens");
+  }
+  {
+    //a copy keeps the whole chain alive after the original goes away
+    RopeString copy;
+    {
+      RopeString rope(piece(0));
+      for (int i = 0; i < NODES; i++) rope = rope + RopeString("z");
+      copy = rope;
+    }
+    check(copy.size() == 130 + NODES && copy.at(130 + NODES - 1) == 'z', "a copy outlives the original rope");
+  }
+}
+
+static void testInterner() {
+  StringInterner interner;
+  std::string literal = "a string literal longer than the inline limit";
+
+  RopeString first = interner.intern(literal);
+  RopeString second = interner.intern(std::string(literal));
+  check(first.view().data() == second.view().data(), "equal literals share one heap copy");
+  check(interner.size() == 1, "an interned literal is stored once");
+
+  RopeString shortLiteral = interner.intern("short");
+  check(shortLiteral.isInline() && interner.size() == 1, "inline literals are not stored");
+
+  check(first == second, "interned literals compare equal");
+  check(first == RopeString(literal), "an interned literal equals a fresh copy");
+  check(!(first == interner.intern(literal + "!")), "different literals are not equal");
+
+  //the shared-node check answers before any bytes are read, so a rope stays unflattened
+  RopeString rope = RopeString(piece(0)) + RopeString(piece(1));
+  RopeString sameNode = rope;
+  check(rope == sameNode && rope.isRope(), "values sharing a node compare equal without flattening");
+}
+
+int main() {
+  testInlineLimit();
+  testFlatLimit();
+  testLeftDeepFlatten();
+  testRightDeepFlatten();
+  testSharedSubrope();
+  testDeepRelease();
+  testInterner();
+
+  if (failures > 0) {
+    std::cerr << failures << " checks failed\n";
+    return 1;
+  }
+  std::cout << "rope string checks passed\n";
+  return 0;
+}